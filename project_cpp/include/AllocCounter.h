@@ -0,0 +1,15 @@
+// AllocCounter.h
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstdint>
+using namespace std;
+
+// Heap allocation counter for the compare-mode benchmarks. Only built with
+// -DDIPETRANS_COUNT_ALLOCS: AllocCounter.cpp then replaces every global
+// operator new (plain, array, aligned, nothrow). Otherwise nothing is
+// replaced and the count stays 0.
+bool allocationCountingEnabled();
+uint64_t allocationCount();
+
+#endif // ALLOC_COUNTER_H
@@ -0,0 +1,40 @@
+// BlockStats.h
+#ifndef BLOCK_STATS_H
+#define BLOCK_STATS_H
+
+#include "DAG.h"
+#include "Transaction.h"
+#include <vector>
+#include <string>
+using namespace std;
+
+// Cheap structural statistics of a block, computed before choosing an execution mode
+struct BlockStats {
+    size_t txCount = 0;
+    size_t edgeCount = 0;
+
+    // edges / (n*(n-1)/2): 0 = fully independent, 1 = every pair conflicts
+    double conflictDensity = 0.0;
+
+    // number of levels on the critical path (1 = everything is independent)
+    size_t longestPath = 0;
+
+    // number of transactions on each topological level
+    vector<size_t> levelWidths;
+    size_t maxWidth = 0;
+    double avgWidth = 0.0;
+
+    // weakly connected components (see Components.h)
+    size_t componentCount = 0;
+    size_t largestComponent = 0;
+
+    // fraction of transactions touching the most accessed key
+    double hotKeySkew = 0.0;
+    string hottestKey;
+
+    string summary() const;
+};
+
+BlockStats computeBlockStats(const DAG &dag, const vector<Transaction> &txs);
+
+#endif // BLOCK_STATS_H
@@ -0,0 +1,46 @@
+// Coarsening.h
+#ifndef COARSENING_H
+#define COARSENING_H
+
+#include "DAG.h"
+#include <vector>
+#include <cstddef>
+using namespace std;
+
+// How much work one dispatch should carry. A transaction evaluates in well under
+// a microsecond, a pool dispatch (queue mutex, wakeup, indegree update) costs
+// about one, so tasks are sized to a multiple of that.
+struct CoarseningPolicy {
+    long long targetTaskNs = 20000;   // estimated work per task
+    size_t maxTxsPerTask = 4096;
+    double measuredTxNs = 0.0;        // moving average of observed per-tx cost; 0 = calibrate first
+};
+
+// Task graph over transaction indices. Tasks run their transactions in order.
+struct CoarsePlan {
+    vector<size_t> taskTxs;           // task t is taskTxs[taskStarts[t] .. taskStarts[t + 1])
+    vector<size_t> taskStarts;
+    IndexedDAG succ;                  // task edges, deduplicated
+    vector<int> indeg;
+    size_t units = 0;                 // nodes after chain contraction
+    size_t chains = 0;                // chains of two or more transactions fused
+    size_t chainedTxs = 0;
+    size_t packedTasks = 0;           // tasks holding more than one unit
+
+    size_t taskCount() const { return taskStarts.empty() ? 0 : taskStarts.size() - 1; }
+    IndexRange task(size_t t) const {
+        return {taskTxs.data() + taskStarts[t], taskTxs.data() + taskStarts[t + 1]};
+    }
+};
+
+// 1. fuses chains u→v where u has one successor and v one predecessor;
+// 2. packs the independent units of each topological level into tasks of about
+//    `txsPerTask` transactions, keeping at least `threads` tasks per level when
+//    the level is wide enough to feed them.
+// `g` is the transaction DAG over block positions (edges point forward in execution order).
+CoarsePlan coarsenSchedule(const IndexedDAG &g, size_t txsPerTask, size_t threads);
+
+// txs per task for the policy's target cost at `txNs` per transaction
+size_t coarseTaskSize(const CoarseningPolicy &policy, double txNs);
+
+#endif // COARSENING_H
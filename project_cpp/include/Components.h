@@ -0,0 +1,34 @@
+// Components.h
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "DAG.h"
+#include <vector>
+#include <string>
+using namespace std;
+
+// Weakly connected components of a DAG. Components share no edge, so each one
+// can run start to finish on a single worker without synchronising with the rest.
+// Positions are grouped by component in one flat array.
+struct ComponentSet {
+    vector<size_t> order;     // component c is order[starts[c] .. starts[c + 1]), in topological order
+    vector<size_t> starts;
+    vector<size_t> depths;    // levels on each component's critical path
+
+    size_t count() const { return depths.size(); }
+    size_t size(size_t c) const { return starts[c + 1] - starts[c]; }
+    IndexRange component(size_t c) const {
+        return {order.data() + starts[c], order.data() + starts[c + 1]};
+    }
+    size_t largest() const;
+    size_t maxDepth() const;
+};
+
+// Union-find over the edge list, split across `threads` workers (lock-free CAS linking)
+ComponentSet findConnectedComponents(const IndexedDAG &g, size_t threads);
+
+// Groups components into work units of roughly `targetTxs` transactions.
+// Large components stay alone; small ones are packed together. Largest unit first.
+vector<vector<size_t>> packComponents(const ComponentSet &set, size_t targetTxs);
+
+#endif // COMPONENTS_H
@@ -23,12 +23,64 @@ public:
 
     void buildFromTransactions(const vector<Transaction> &txs);
 
+    // For incremental maintenance: callers remove incoming edges first (they
+    // know the predecessors); removeNode drops the node and its outgoing edges
+    void removeEdge(const string &from, const string &to);
+    void removeNode(const string &id);
+
     const unordered_map<string, vector<string>>& getAdjList() const { return adj; }
     const unordered_map<string, int>& getInDegree() const { return indegree; }
 
     void displayGraph() const;
 
     vector<string> getAllNodes() const;
+
+    // Kahn levels: level k holds every node whose longest path from a root has k edges
+    vector<vector<string>> getLevels() const;
+};
+
+// Contiguous run of positions, e.g. one node's successors or one level
+struct IndexRange {
+    const size_t *first;
+    const size_t *last;
+    const size_t *begin() const { return first; }
+    const size_t *end() const { return last; }
+    size_t size() const { return (size_t)(last - first); }
+    size_t operator[](size_t i) const { return first[i]; }
+};
+
+// A graph over positions 0..n-1 in flat (CSR) arrays: the successors of i are
+// targets[offsets[i] .. offsets[i + 1]). Executors use it instead of the
+// string-keyed DAG so their setup allocates a few arrays, not one node per
+// transaction.
+struct IndexedDAG {
+    vector<size_t> offsets;   // n + 1 entries
+    vector<size_t> targets;
+
+    size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    size_t edgeCount() const { return targets.size(); }
+    IndexRange successors(size_t i) const {
+        return {targets.data() + offsets[i], targets.data() + offsets[i + 1]};
+    }
+};
+
+// Kahn levels over positions, flat: level k is order[starts[k] .. starts[k + 1]),
+// each in ascending position order
+struct LevelOrder {
+    vector<size_t> order;
+    vector<size_t> starts;    // levels + 1 entries
+
+    size_t levels() const { return starts.empty() ? 0 : starts.size() - 1; }
+    IndexRange level(size_t k) const {
+        return {order.data() + starts[k], order.data() + starts[k + 1]};
+    }
 };
 
+// `dag` re-expressed over positions in `txs`; edges to or from ids that are not
+// in `txs` are dropped. Ids are matched through one open-addressing table.
+IndexedDAG indexDAG(const DAG &dag, const vector<Transaction> &txs);
+
+// same definition as DAG::getLevels; nodes on a cycle get no level
+LevelOrder topologicalLevels(const IndexedDAG &g);
+
 #endif // DAG_H
\ No newline at end of file
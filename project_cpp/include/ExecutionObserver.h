@@ -3,9 +3,7 @@
 #include <functional>
 #include <string>
 #include <vector>
-#include <unordered_map>
-
-using TxDelta = std::unordered_map<std::string, long long>;
+#include "TxDelta.h"
 
 struct ExecutionObserver {
     // batchId, list of tx ids in batch
@@ -15,7 +13,7 @@ struct ExecutionObserver {
     // txId, threadId (as string), delta map
     std::function<void(const std::string&, const std::string&, const TxDelta&)> onTxEvaluated;
     // batchId, groupId, merged delta
-    std::function<void(int, int, const TxDelta&)> onGroupMerged;
+    std::function<void(int, int, const StateDelta&)> onGroupMerged;
     // execution finished
     std::function<void()> onExecutionEnd;
 };
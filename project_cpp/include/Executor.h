@@ -8,24 +8,102 @@
 #include "State.h"
 #include "Metrics.h"
 #include "ExecutionObserver.h"   // new
+#include "BlockStats.h"
+#include "StateBackend.h"
+#include "Partitioner.h"
+#include "Coarsening.h"
+#include "ScheduleCache.h"
 #include <vector>
 #include <string>
 
 using namespace std;
 
+// Every strategy takes the same DAG, transactions, State and Metrics, so they can be
+// swapped at runtime through Executor::execute and compared on identical inputs.
+enum class ExecutionMode {
+    Sequential,        // block order on the calling thread: no pool, no locks
+    ParallelBatches,   // topological levels, each split into one chunk per thread
+    BatchThreads,      // topological levels, one std::thread per transaction
+    PriorityBatches,   // levels dispatched to the pool highest fee / earliest timestamp first
+    ThreadPoolBatches, // levels on the ThreadPool, one task per transaction
+    Waves,             // zero-indegree batches split into conflict-free groups (executeWithState)
+    DependencyDriven,  // each tx is released as soon as its last predecessor commits
+    Components,        // weakly connected components run whole on one worker each
+    Coarsened          // fused chains + packed chunks, released like DependencyDriven
+};
+
+string executionModeName(ExecutionMode mode);
+
+// Accepts the names executionModeName returns; false if unknown
+bool parseExecutionMode(const string &name, ExecutionMode &mode);
+
+vector<ExecutionMode> allExecutionModes();
+
+// Demo transfer semantics shared by every strategy
+TxDelta evaluateTransaction(const Transaction &t);
+
+// The transfer itself (first read key → first write key), for callers that
+// hold the keys without a Transaction, e.g. spilled records
+TxDelta evaluateTransfer(const string &from, const string &to);
+
+// Thresholds used by executeAdaptive. Defaults are starting points; calibrate
+// them against the "adaptive" lines that Metrics::logDecision writes.
+struct AdaptivePolicy {
+    size_t sequentialMaxTxs = 64;     // below this, pool startup dominates
+    double serialDepthRatio = 0.5;    // longestPath >= ratio * txs → almost serial
+    size_t wavesMaxDepth = 8;         // few levels → few barriers to pay for
+    double wavesMaxSkew = 0.05;       // a hot key splits waves into many small groups
+    size_t minTxsPerThread = 4;       // per level, to amortise dispatch cost
+    double componentsMaxShare = 0.25; // largest component's share of the block
+};
+
 class Executor {
 public:
     // observer: GUI or instrumentation can set callbacks here
     ExecutionObserver observer;
 
-    void executeSequential(const DAG &dag);
-    void executeParallelBatches(const DAG &dag);
-    void executeParallelBatchesWithThreads(const DAG &dag);
-    void executePriorityScheduledBatches(const DAG &dag, const vector<Transaction> &txs);
-    void executeWithThreadPool(const DAG &dag, const vector<Transaction> &txs);
+    // how executeWithState splits each batch into conflict-free groups
+    PartitionStrategy partitionStrategy = PartitionStrategy::Greedy;
+
+    // Runs `mode` and logs "strategy=<name> ... runUs=..." to metrics
+    void execute(ExecutionMode mode, DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics);
+
+    // Baselines (commits 2-6), no per-tx console/trace output
+    void executeSequential(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics);
+    void executeParallelBatches(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics);
+    void executeParallelBatchesWithThreads(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics);
+    void executePriorityScheduledBatches(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics);
+    void executeWithThreadPool(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics);
 
     // Commit 7/8 version - state-aware execution (instrumented)
     void executeWithState(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics);
+
+    // Fast paths used by executeAdaptive (no per-tx console/trace output)
+    void executeDependencyDriven(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics);
+    void executeByComponents(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics);
+
+    // Dependency-driven over a coarsened task graph (see Coarsening.h). Each run
+    // feeds its measured per-tx cost back into `coarsening`, so chunk sizes follow
+    // the real cost of the workload.
+    CoarseningPolicy coarsening;
+    void executeCoarsened(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics);
+
+    // State lives behind a slow backend: each worker keeps up to maxInFlight transactions
+    // suspended on their key loads and resumes whichever is resident first; successors
+    // one predecessor away are prefetched. maxInFlight <= 1 is the blocking baseline.
+    void executeWithPrefetch(DAG &dag, vector<Transaction> &txs, State &state, SlowStateBackend &backend,
+                             size_t threadPoolSize, size_t maxInFlight, Metrics &metrics);
+
+    // Waves schedule (levels + partitionStrategy groups) looked up by block shape;
+    // on a hit the DAG build and partitioning are skipped. Builds the DAG itself
+    // on a miss, so callers pass only the block.
+    void executeWithScheduleCache(vector<Transaction> &txs, State &state, ScheduleCache &cache,
+                                  size_t threadPoolSize, Metrics &metrics);
+
+    // Picks a mode and thread count from BlockStats, runs it and logs decision + outcome
+    AdaptivePolicy adaptivePolicy;
+    ExecutionMode chooseExecutionMode(const BlockStats &stats, size_t maxThreads, size_t &threads) const;
+    void executeAdaptive(DAG &dag, vector<Transaction> &txs, State &state, size_t maxThreads, Metrics &metrics);
 };
 
 #endif // EXECUTOR_H
@@ -0,0 +1,67 @@
+// IncrementalExecutor.h
+#ifndef INCREMENTAL_EXECUTOR_H
+#define INCREMENTAL_EXECUTOR_H
+
+#include "DAG.h"
+#include "Transaction.h"
+#include "State.h"
+#include "Metrics.h"
+#include "Executor.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+using namespace std;
+
+// Keeps a block's DAG, key index and per-transaction deltas after a full run,
+// so that amending the block (mempool replacement, a small reorg) re-executes
+// only the edited transactions and everything downstream of them.
+// Deltas compose additively, so unaffected transactions' results are reused as-is.
+class IncrementalExecutor {
+private:
+    struct Entry {
+        Transaction tx;
+        unsigned long long position;  // block order; edges go from lower to higher
+        bool alive;
+        bool hasDelta;
+        TxDelta delta;
+    };
+
+    vector<Entry> entries;                 // tombstoned on removal, so indices stay stable
+    unordered_map<string, size_t> byId;
+    unordered_map<string, unordered_set<size_t>> readers;
+    unordered_map<string, unordered_set<size_t>> writers;
+    unsigned long long nextPosition = 0;
+
+    DAG dag;
+    unordered_set<size_t> seeds;           // edited or exposed since the last run
+    unordered_set<string> createdKeys;     // absent from State until a block transaction touched them
+
+    unordered_set<size_t> conflictsOf(size_t e) const;
+    void link(size_t e);
+    void unlink(size_t e);
+    void noteCreatedKeys(const Transaction &tx, const State &state);
+    bool touchedByLiveDelta(const string &key) const;
+
+public:
+    // Full run with any strategy; per-tx deltas are captured through the observer
+    void executeBlock(const vector<Transaction> &block, State &state,
+                      ExecutionMode mode, size_t threadPoolSize, Metrics &metrics);
+
+    bool addTransaction(const Transaction &tx);       // appended at the end; false if the id exists
+    bool removeTransaction(const string &txId);
+    bool replaceTransaction(const Transaction &tx);   // same id keeps its block position
+
+    // Reverts the stale deltas of the dirty closure, re-executes it in block
+    // order and applies the new deltas. Keys that exist only because of a
+    // reverted delta are erased, as a from-scratch run would never create them.
+    // Returns how many transactions ran.
+    size_t reexecute(State &state, Metrics &metrics);
+
+    const DAG &getDAG() const { return dag; }
+
+    // Current block in block order (what a from-scratch run would execute)
+    vector<Transaction> currentBlock() const;
+};
+
+#endif // INCREMENTAL_EXECUTOR_H
@@ -0,0 +1,111 @@
+// LiveStats.h
+#ifndef LIVE_STATS_H
+#define LIVE_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <functional>
+using namespace std;
+
+// Fixed-layout stats segment in POSIX shared memory, read live by tools/live_stats.
+//
+// Hot path (workers): each thread owns a cache-line-aligned counter slot and
+// only does relaxed adds on it; no lock, no shared cache line.
+// Gauges (batch/group, ready-queue depth, active workers, tx/s) are assembled by
+// one sampler thread and published under a seqlock, so readers always see a
+// consistent snapshot and writers never wait for readers.
+namespace livestats {
+
+const uint32_t kMagic = 0x44505354;   // "DPST"
+const uint32_t kVersion = 2;
+const size_t kWorkerSlots = 64;
+const size_t kLatencyBuckets = 32;    // bucket b counts latencies in [2^b, 2^(b+1)) ns
+
+struct alignas(64) WorkerSlot {
+    atomic<uint64_t> txCompleted;
+    atomic<uint64_t> latency[kLatencyBuckets];
+};
+
+struct Snapshot {
+    uint64_t updatedNs;        // steady clock of the last publish
+    uint64_t txCompleted;
+    uint64_t txTotal;
+    uint64_t txPerSec;
+    uint64_t currentBatch;
+    uint64_t currentGroup;
+    uint64_t readyQueueDepth;
+    uint64_t activeWorkers;
+    char mode[32];
+};
+
+struct Segment {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t workerSlots;
+    uint32_t latencyBuckets;
+    uint64_t pid;
+    alignas(64) atomic<uint64_t> seq;   // odd while the sampler is writing `snapshot`
+    Snapshot snapshot;
+    WorkerSlot workers[kWorkerSlots];
+};
+
+// Reader side: retries until it copies a snapshot that no write overlapped
+bool readSnapshot(const Segment *seg, Snapshot &out);
+
+} // namespace livestats
+
+class LiveStats {
+public:
+    static LiveStats& get();
+
+    // Creates the segment and starts the sampler; until then every call is a no-op.
+    // Fails (errno EEXIST) rather than take over a segment that already exists.
+    bool open(const string &name, unsigned intervalMs = 100);
+    void close();
+    bool isOpen() const { return seg.load(memory_order_relaxed) != nullptr; }
+
+    // hot path, any thread: `count` transactions whose deltas reached the state
+    // `latencyNs` after they were dispatched (enqueued, or their level started)
+    void txCompleted(uint64_t latencyNs, uint64_t count = 1);
+
+    // coordinator progress, copied into the next snapshot
+    void setMode(const string &mode, uint64_t txTotal);
+    void setProgress(uint64_t batch, uint64_t group);
+
+    // queue gauges are sampled from these callbacks (e.g. a ThreadPool's atomics)
+    int addGaugeSource(const function<uint64_t()> &readyDepth, const function<uint64_t()> &active);
+    void removeGaugeSource(int id);
+
+private:
+    LiveStats() = default;
+    ~LiveStats();
+    void publish();
+
+    atomic<livestats::Segment*> seg{nullptr};
+    string segName;
+
+    atomic<uint64_t> batch{0}, group{0}, total{0};
+    mutex modeMutex;          // sampler and setMode only, never workers
+    string mode;
+
+    struct GaugeSource {
+        int id;
+        function<uint64_t()> readyDepth;
+        function<uint64_t()> active;
+    };
+    mutex sourcesMutex;       // sampler and pool construction/destruction only
+    vector<GaugeSource> sources;
+    int nextSourceId = 0;
+
+    thread sampler;
+    atomic<bool> stopSampler{false};
+    unsigned interval = 100;
+    uint64_t lastCompleted = 0;
+    uint64_t lastNs = 0;
+};
+
+#endif // LIVE_STATS_H
@@ -24,8 +24,18 @@ public:
 
     // measureDuration accepts a callable and returns elapsed ms
     long long measureDuration(function<void()> func);
+    // same, in microseconds (small blocks finish well under a millisecond)
+    long long measureDurationUs(function<void()> func);
+
+    // measureDurationUs that also charges hardware/software counters to `phase`
+    // when PerfProfiler is enabled (threads created inside the phase included)
+    long long measurePhase(const string &phase, function<void()> func);
 
     void log(const string &msg);
+
+    // one line per adaptive decision + outcome, greppable for threshold calibration
+    void logDecision(const string &mode, size_t threads, const string &stats,
+                     long long statsUs, long long runUs, size_t txCount);
 };
 
 #endif // METRICS_H
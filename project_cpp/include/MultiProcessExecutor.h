@@ -0,0 +1,57 @@
+// MultiProcessExecutor.h
+#ifndef MULTI_PROCESS_EXECUTOR_H
+#define MULTI_PROCESS_EXECUTOR_H
+
+#include "DAG.h"
+#include "Transaction.h"
+#include "State.h"
+#include "Metrics.h"
+#include <vector>
+#include <string>
+using namespace std;
+
+// Coordinator/worker execution across local processes (POSIX only).
+// The coordinator owns the DAG and the indegree bookkeeping. Forked workers
+// pop ready transaction indices from their own lock-free queue in a POSIX
+// shared memory segment, which also holds the balance of every key the block
+// touches. Workers compute each delta from the encoded transfer alone (the
+// transfer semantics never read a balance) and return it through their own done
+// queue; only the coordinator commits deltas to the shared balances, so each
+// is applied exactly once. They are copied back into `state` at the end. A
+// worker owns at most a fixed number of tasks, so queues do not grow with the
+// block. Every queue has one producer and one consumer, so a worker killed at
+// any point, even inside a queue operation, can only stall its own queues. It
+// is reaped by pid, its published results are taken, its queues are reset and
+// it is replaced; exactly the tasks dispatched to it that have not completed
+// are re-dispatched.
+class MultiProcessExecutor {
+public:
+    explicit MultiProcessExecutor(size_t workerProcesses);
+
+    // test hook: each worker _exit()s after this many tasks (0 = never)
+    size_t crashAfterTasks = 0;
+
+    // test hook: the coordinator SIGKILLs a random worker every this many
+    // microseconds (0 = never), wherever that worker happens to be
+    size_t killEveryUs = 0;
+
+    // false if shared memory or fork is unavailable, or every worker died and
+    // none could be forked again; `state` is then untouched. If only some
+    // workers can be forked, the run uses those.
+    bool execute(DAG &dag, vector<Transaction> &txs, State &state, Metrics &metrics);
+
+    // average round trip of an empty task through the shared-memory queues and
+    // through the in-process ThreadPool, logged as "handoff ..." lines
+    void measureHandoffLatency(size_t tasks, Metrics &metrics);
+
+    // throughput sweep over 1, 2, 4 .. maxWorkers: worker processes against the
+    // same number of ThreadPool threads (dependency mode) on copies of `state`;
+    // logs "multiprocess scaling ..." lines and prints a table
+    static void measureScaling(DAG &dag, vector<Transaction> &txs, const State &state,
+                               size_t maxWorkers, Metrics &metrics);
+
+private:
+    size_t workers;
+};
+
+#endif // MULTI_PROCESS_EXECUTOR_H
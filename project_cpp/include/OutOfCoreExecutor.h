@@ -0,0 +1,96 @@
+// OutOfCoreExecutor.h
+#ifndef OUT_OF_CORE_EXECUTOR_H
+#define OUT_OF_CORE_EXECUTOR_H
+
+#include "Transaction.h"
+#include "State.h"
+#include "Metrics.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <string>
+using namespace std;
+
+struct SpillConfig {
+    string dir = "spill";
+    // Everything the executor keeps in memory for the block: the key-level
+    // table while adding, the per-level counters, seal's staging window and
+    // level buckets, and the mapped segments while executing. The caller's
+    // State (one balance per account) is the result and is not counted.
+    size_t memoryBudgetBytes = 64u << 20;
+    size_t lookaheadSegments = 2;     // segments mapped and paged in ahead of the executing one
+};
+
+struct SpillStats {
+    size_t txs = 0;
+    size_t levels = 0;
+    size_t maxLevelTxs = 0;
+    size_t segments = 0;
+    size_t keySlots = 0;              // key-level table size (slots are shared by hash)
+    size_t bucketFlushes = 0;         // seal: times the level buckets were written out
+    size_t barriers = 0;              // level changes: the pool is drained before the next level
+    size_t segmentDrains = 0;         // segment ends inside a level, drained so the segment can be unmapped
+    size_t prefetchStalls = 0;        // times execution waited for a segment to be paged in
+    uint64_t bytes = 0;
+    uint64_t segmentBytes = 0;
+    uint64_t peakMappedBytes = 0;
+    uint64_t peakBudgetedBytes = 0;   // largest sum of the structures the budget covers
+    uint64_t levelBookkeepingBytes = 0; // per-level counters at seal, charged before the buffers
+    uint64_t peakRssBytes = 0;        // whole process, at the end of execute()
+    long long spillUs = 0;            // add(): level assignment + staging writes
+    long long sealUs = 0;
+    long long executeUs = 0;
+};
+
+// Memory-bounded execution for blocks larger than RAM (POSIX only).
+// Transactions are appended in block order to a staging file. Each one's
+// topological level is found on arrival from two counters per key (level of
+// the last writer, highest reader level), so neither a DAG nor a tx table is
+// kept in memory. The counters live in a fixed table of half the budget,
+// indexed by key hash: keys that share a slot share counters, which can only
+// raise a level (a false conflict, never a missed one). seal() reads the
+// staging file once through a mapped window, appending each record to its
+// level's bucket and writing the buckets to their level's place in the
+// level-ordered file whenever they fill, so it is linear in the spilled
+// bytes. execute() maps that file one segment at a time:
+// the executing segment plus `lookaheadSegments` that a prefetch thread pages
+// in ahead. Levels are conflict-free, so adjacency is never stored; the pool
+// is drained whenever the level changes.
+class OutOfCoreExecutor {
+public:
+    explicit OutOfCoreExecutor(const SpillConfig &config);
+    ~OutOfCoreExecutor();   // removes the spill files, and the directory if it created it
+
+    // false on I/O errors, if spilling is unavailable on this platform, or if
+    // the id, a key, the read set or the write set exceeds UINT16_MAX bytes or
+    // entries; a rejected transaction leaves no trace in the spill
+    bool add(const Transaction &tx);
+    bool seal(Metrics &metrics);
+    bool execute(State &state, size_t threads, Metrics &metrics);
+
+    const SpillStats& getStats() const { return stats; }
+
+private:
+    struct KeyLevels {
+        uint32_t lastWrite = 0;   // level + 1 of the last writer, 0 = none
+        uint32_t maxRead = 0;     // highest level + 1 among readers
+    };
+
+    // what the budget has left for buffers once `perLevel` bytes per level are charged
+    size_t bufferBytes(size_t perLevel) const;
+    void chargeBudget(uint64_t bytes);
+
+    SpillConfig config;
+    SpillStats stats;
+    vector<KeyLevels> keyLevels;      // keySlots entries, a power of two
+    size_t stagingBufferBytes = 0;
+    vector<uint64_t> levelBytes;
+    vector<size_t> levelTxs;
+    vector<uint64_t> segmentStarts;   // record-aligned offsets into the level file, plus its size
+    FILE *staging = nullptr;
+    string stagingPath, levelPath;
+    bool sealed = false;
+    bool createdDir = false;
+};
+
+#endif // OUT_OF_CORE_EXECUTOR_H
@@ -0,0 +1,31 @@
+// Partitioner.h
+#ifndef PARTITIONER_H
+#define PARTITIONER_H
+
+#include "Transaction.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+using namespace std;
+
+// How executeWithState splits a batch into conflict-free groups. Every group
+// costs one pool.waitAll() barrier, so fewer and evenly sized groups are better.
+enum class PartitionStrategy {
+    Greedy,  // first fit in batch order, pairwise conflict checks (commit 8)
+    DSatur   // DSatur coloring of the batch's conflict graph, built from a key index
+};
+
+string partitionStrategyName(PartitionStrategy strategy);
+bool parsePartitionStrategy(const string &name, PartitionStrategy &strategy);
+
+bool transactionsConflict(const Transaction &A, const Transaction &B);
+
+vector<vector<string>> partitionIntoConflictFreeGroups(
+    const vector<string> &batch,
+    const unordered_map<string, const Transaction*> &lookup,
+    PartitionStrategy strategy = PartitionStrategy::Greedy);
+
+// sum over groups of ceil(size / threads): barrier-separated rounds of pool work
+size_t partitionRounds(const vector<vector<string>> &groups, size_t threads);
+
+#endif // PARTITIONER_H
@@ -0,0 +1,80 @@
+// PerfCounters.h
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <string>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <vector>
+using namespace std;
+
+class Metrics;
+
+// One reading of the counters that were available. perf_event_open hardware
+// events come first; containers often refuse them, so software perf events
+// (task clock, context switches) and finally getrusage fill in.
+struct CounterSet {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t llcMisses = 0;
+    uint64_t contextSwitches = 0;
+    uint64_t taskClockNs = 0;
+    uint64_t userUs = 0, sysUs = 0;   // getrusage, always filled
+    bool hardware = false;            // cycles/instructions are real
+    bool llc = false;                 // llcMisses is real: last-level cache read misses
+    bool software = false;            // taskClockNs/contextSwitches come from perf
+
+    void add(const CounterSet &o);
+    string source() const { return hardware ? "hw" : software ? "sw" : "rusage"; }
+};
+
+// Counts the calling thread. With includeNewThreads, threads it creates while
+// counting (e.g. a ThreadPool built inside a phase) are folded in when they exit.
+class PerfCounters {
+public:
+    explicit PerfCounters(bool includeNewThreads);
+    ~PerfCounters();
+    void start();
+    CounterSet stop();
+
+private:
+    enum { Cycles, Instructions, LlcMisses, ContextSwitches, TaskClock, EventCount };
+    int fds[EventCount];
+    bool inherit;
+    bool running = false;
+    uint64_t userUs0 = 0, sysUs0 = 0, ctx0 = 0;
+};
+
+// Collects per-phase and per-worker readings while enabled (app --perf)
+class PerfProfiler {
+public:
+    static PerfProfiler& get();
+
+    void enable() { on.store(true, memory_order_relaxed); }
+    bool enabled() const { return on.load(memory_order_relaxed); }
+
+    void recordPhase(const string &phase, long long wallUs, const CounterSet &c);
+    void recordWorker(long long wallUs, const CounterSet &c);   // one pool worker's lifetime
+
+    // "perf phase=..." and "perf workers=..." lines in metrics.log, plus a table on stdout
+    void writeSummary(Metrics &metrics);
+
+private:
+    PerfProfiler() = default;
+    struct PhaseTotals {
+        size_t calls = 0;
+        long long wallUs = 0;
+        CounterSet counters;
+    };
+    atomic<bool> on{false};
+    mutex m;
+    vector<string> order;             // first-seen order of phases
+    map<string, PhaseTotals> phases;
+    size_t workers = 0;
+    long long workerWallUs = 0;       // summed over workers, like their counters
+    CounterSet workerTotals;
+};
+
+#endif // PERF_COUNTERS_H
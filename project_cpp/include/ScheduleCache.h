@@ -0,0 +1,64 @@
+// ScheduleCache.h
+#ifndef SCHEDULE_CACHE_H
+#define SCHEDULE_CACHE_H
+
+#include "Transaction.h"
+#include "Partitioner.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+using namespace std;
+
+// A waves schedule in block positions: batches → conflict-free groups → txs.
+// Groups run one after another, the transactions of a group in parallel.
+typedef vector<vector<vector<uint32_t>>> Schedule;
+
+// Canonical read/write structure of a block. Keys are renumbered in order of
+// first use (block order, names sorted within a set) and ids, fees and
+// timestamps are ignored, so payout-style blocks that touch the same accounts
+// the same way map to the same shape.
+struct BlockShape {
+    uint64_t fingerprint = 0;
+    vector<uint32_t> canonical;   // per tx: reads, writes, read ids..., write ids...; then the strategy
+};
+
+BlockShape computeBlockShape(const vector<Transaction> &txs, PartitionStrategy strategy);
+
+// Checks `schedule` against the block itself, independent of any fingerprint:
+// every position appears once, no group holds a conflicting pair, and each
+// conflicting pair runs in block order
+bool scheduleValidFor(const Schedule &schedule, const vector<Transaction> &txs);
+
+// Schedules by shape, in memory and, with a directory, as <dir>/<fingerprint>.sched
+// so later processes start warm. A cached schedule is used only if the stored
+// canonical form equals the block's and scheduleValidFor() accepts it.
+class ScheduleCache {
+public:
+    explicit ScheduleCache(const string &dir = "");
+
+    bool lookup(const BlockShape &shape, const vector<Transaction> &txs, Schedule &out, long long &buildUs);
+    void insert(const BlockShape &shape, const Schedule &schedule, long long buildUs);
+
+    size_t lookups = 0;
+    size_t hits = 0;
+    size_t rejected = 0;          // fingerprint matched but exact validation failed
+    long long savedUs = 0;        // build + partition time not spent on hits, minus validation
+
+    double hitRate() const { return lookups ? (double)hits / (double)lookups : 0.0; }
+
+private:
+    struct Entry {
+        vector<uint32_t> canonical;
+        Schedule schedule;
+        long long buildUs = 0;
+    };
+    string dir;
+    unordered_map<uint64_t, Entry> entries;
+
+    string pathFor(uint64_t fingerprint) const;
+    bool load(uint64_t fingerprint, Entry &e) const;
+    void save(uint64_t fingerprint, const Entry &e) const;
+};
+
+#endif // SCHEDULE_CACHE_H
@@ -0,0 +1,103 @@
+// Simulator.h
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "DAG.h"
+#include "Transaction.h"
+#include "Executor.h"
+#include "Metrics.h"
+#include "Partitioner.h"
+#include <vector>
+#include <string>
+using namespace std;
+
+enum class CostModelKind {
+    Constant,    // every transaction costs the same
+    Sampled,     // costs drawn from a given distribution (e.g. production timings)
+    Calibrated   // per-tx costs and pool/thread overheads measured on this machine
+};
+
+// Virtual time charged by the simulator, in nanoseconds
+struct CostModel {
+    CostModelKind kind = CostModelKind::Constant;
+    vector<double> txNs;          // per block position
+    double dispatchNs = 0.0;      // per pool task submitted in a level burst by the coordinator
+    double chainDispatchNs = 0.0; // per pool task released from inside a finishing task (dependency)
+    double barrierNs = 0.0;       // per waitAll()
+    double spawnNs = 0.0;         // per std::thread created and joined (batches levels, pool start/stop)
+    vector<double> runNs;         // by ExecutionMode: per-run offset fitted from real runs, empty = none
+    bool chargeSetup = false;     // add each strategy's measured schedule preparation
+
+    static CostModel constant(size_t txCount, double ns, double dispatchNs = 0.0, double barrierNs = 0.0);
+    static CostModel sampled(size_t txCount, const vector<double> &samples, unsigned seed);
+    // Times each transaction of the block, an empty barrier and a thread
+    // spawn/join; the per-task dispatch costs come from
+    // ScheduleSimulator::calibrateDispatch. Logs the fitted values as a
+    // "simcal" line. If observedTxNs is set (a real sequential run's time per
+    // tx) the per-tx costs are scaled to it, so state updates around the
+    // evaluation are charged too.
+    static CostModel calibrate(const vector<Transaction> &txs, Metrics &metrics, double observedTxNs = 0.0);
+
+    string name() const;
+    double meanTxNs() const;
+    double runOffsetNs(ExecutionMode mode) const {
+        return (size_t)mode < runNs.size() ? runNs[(size_t)mode] : 0.0;
+    }
+};
+
+struct SimResult {
+    ExecutionMode mode = ExecutionMode::Sequential;
+    size_t workers = 1;
+    size_t tasks = 0;
+    size_t barriers = 0;
+    double makespanNs = 0.0;      // setup + schedule + run offset
+    double setupNs = 0.0;         // schedule preparation: levels, index, components, plan
+    double busyNs = 0.0;          // transaction work only
+    double barrierIdleNs = 0.0;   // worker time spent waiting for a level/group to drain
+
+    double utilization() const { return makespanNs > 0 ? busyNs / (makespanNs * (double)workers) : 0.0; }
+};
+
+// Predictions further off than this in the real-run check are flagged
+const double kSimErrorBoundPct = 25.0;
+
+// Replays a strategy's schedule for a real DAG on `workers` virtual workers.
+// Barrier strategies (batches, pool, priority, waves) are simulated phase by
+// phase with greedy earliest-free-worker assignment; dependency, components
+// and coarse as discrete events over their task graphs. batches pays a thread
+// spawn per extra chunk and level, pool strategies one pool start/stop. With a
+// calibrated model each strategy is also charged its schedule preparation,
+// timed on this DAG (level and index construction are timed here, components
+// and the coarsening pass when simulated).
+class ScheduleSimulator {
+public:
+    ScheduleSimulator(const DAG &dag, const vector<Transaction> &txs,
+                      PartitionStrategy partition = PartitionStrategy::Greedy);
+
+    // threads (one OS thread per tx) is left to the OS scheduler and not modelled
+    static bool supports(ExecutionMode mode);
+    SimResult simulate(ExecutionMode mode, size_t workers, const CostModel &cost) const;
+
+    // Fits dispatchNs and chainDispatchNs by running this block's transactions
+    // on a one-worker pool in the real task shapes: each level as a burst of
+    // delta-slot tasks, and the DAG released task by task from the workers.
+    // What exceeds the model's tx and barrier costs is the per-task dispatch.
+    void calibrateDispatch(CostModel &cost, Metrics &metrics) const;
+
+private:
+    const DAG &dag;
+    const vector<Transaction> &txs;
+    IndexedDAG graph;                             // by block position
+    LevelOrder levels;                            // positions
+    vector<vector<vector<size_t>>> waves;         // batches → conflict-free groups
+    double levelSetupNs = 0.0;                    // levels resolved to transactions
+    double indexSetupNs = 0.0;                    // id → position index and successor arrays
+    double partitionSetupNs = 0.0;                // waves groups on top of the levels
+
+    void simulatePhases(const vector<vector<double>> &phases, size_t workers, const CostModel &cost, SimResult &r) const;
+    void simulateThreadLevels(const vector<vector<double>> &levelChunks, const CostModel &cost, SimResult &r) const;
+    void simulateGraph(const vector<double> &taskNs, const IndexedDAG &taskSucc, size_t workers,
+                       double dispatchNs, const CostModel &cost, SimResult &r) const;
+};
+
+#endif // SIMULATOR_H
@@ -2,24 +2,36 @@
 #define STATE_H
 
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <iostream>
+#include "TxDelta.h"
 using namespace std;
 
 class State {
 private:
     unordered_map<string, long long> balances;
+    bool trackDirty = false;
+    unordered_set<string> dirty;   // keys written since the last takeDirtyKeys()
 
 public:
     State() = default;
     State(const unordered_map<string, long long> &init);
 
     long long getBalance(const string &key) const;
-    void applyDelta(const unordered_map<string, long long> &delta);
+    const unordered_map<string, long long>& getBalances() const { return balances; }
+    void applyDelta(const StateDelta &delta);
+    void applyDelta(const TxDelta &delta);
     void display() const;
 
     // For convenience in Utils
     void setBalance(const string &key, long long value);
+    // Drops the key; it reads as 0 again but is no longer listed
+    void eraseBalance(const string &key);
+
+    // Dirty-key tracking for StateCommitment; off by default, so plain runs pay nothing
+    void setDirtyTracking(bool on);
+    unordered_set<string> takeDirtyKeys();
 };
 
 #endif // STATE_H
\ No newline at end of file
@@ -0,0 +1,53 @@
+// StateBackend.h
+#ifndef STATE_BACKEND_H
+#define STATE_BACKEND_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+using namespace std;
+
+// Simulated slow storage under State: the first access to a key costs
+// `coldLatency` (a large table or a disk read), later accesses are free.
+// Loads go through one request queue served by `ioDepth` I/O threads, whether
+// the caller blocks on them (load) or not (prefetch), so both see the same depth.
+class SlowStateBackend {
+private:
+    chrono::microseconds coldLatency;
+
+    unordered_set<string> resident;
+    unordered_set<string> pending;
+    deque<string> requests;
+
+    mutable mutex m;
+    condition_variable requestReady;
+    condition_variable loadDone;
+    bool stop;
+    vector<thread> io;
+
+public:
+    SlowStateBackend(chrono::microseconds coldLatency, size_t ioDepth);
+    ~SlowStateBackend();
+
+    // queues a load if the key is not resident and blocks until it is
+    void load(const string &key);
+
+    // queues an asynchronous load; returns immediately
+    void prefetch(const string &key);
+
+    bool isResident(const string &key) const;
+
+    // waits until any outstanding load completes, or maxWait passes
+    void waitForLoads(chrono::microseconds maxWait);
+
+    // drops everything back to cold, for A/B runs on the same backend; waits
+    // for loads already in service, discards queued ones
+    void evictAll();
+};
+
+#endif // STATE_BACKEND_H
@@ -0,0 +1,52 @@
+// StateCommitment.h
+#ifndef STATE_COMMITMENT_H
+#define STATE_COMMITMENT_H
+
+#include "State.h"
+#include "ThreadPool.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_set>
+using namespace std;
+
+typedef array<uint8_t, 32> Hash256;
+
+Hash256 sha256(const uint8_t *data, size_t len);
+string hashToHex(const Hash256 &h);
+
+// Sparse Merkle commitment over State. Keys hash (SHA-256) into 2^depth leaf
+// buckets; a leaf is SHA-256 of its bucket's (u32 key length, key, i64 balance)
+// records in key order, integers big-endian; an inner node is SHA-256 of its
+// two children, an empty subtree all zeroes.
+// update() rehashes only the dirty buckets and their paths to the root, so the
+// cost follows the number of keys a block touched, not the size of State.
+class StateCommitment {
+public:
+    explicit StateCommitment(unsigned depth = 16);
+
+    // Hashes every key of `state` (used once, and to cross-check update())
+    void build(const State &state, ThreadPool *pool = nullptr);
+
+    // Rehashes the buckets of `dirtyKeys` and their paths; levels are split
+    // across `pool` when enough nodes are dirty. Returns the number of nodes hashed.
+    size_t update(const State &state, const unordered_set<string> &dirtyKeys, ThreadPool *pool = nullptr);
+
+    const Hash256& root() const { return tree[1]; }
+    string rootHex() const { return hashToHex(root()); }
+    unsigned getDepth() const { return depth; }
+
+private:
+    unsigned depth;
+    size_t leafCount;
+    vector<Hash256> tree;                // heap layout: node i has children 2i, 2i+1; leaves at leafCount..
+    vector<vector<string>> buckets;      // sorted keys per leaf
+
+    size_t bucketOf(const string &key) const;
+    void hashLeaf(const State &state, size_t bucket);
+    void hashInner(size_t node);
+    void forEachParallel(ThreadPool *pool, size_t count, void (*fn)(void *ctx, size_t begin, size_t end), void *ctx);
+};
+
+#endif // STATE_COMMITMENT_H
@@ -3,29 +3,127 @@
 
 #include <vector>
 #include <thread>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
-#include <functional>
 #include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 using namespace std;
 
+// Move-only task with inline storage: the callable lives inside the object, so
+// submitting and running a task never touches the heap. Callables that do not
+// fit must capture by reference (or use the function-pointer overload).
+class PoolTask {
+public:
+    static const size_t kInlineSize = 56;
+
+    PoolTask() : ops(nullptr) {}
+
+    template <typename F, typename = typename enable_if<!is_same<typename decay<F>::type, PoolTask>::value>::type>
+    PoolTask(F &&f) {
+        typedef typename decay<F>::type Fn;
+        static_assert(sizeof(Fn) <= kInlineSize, "task capture too large for PoolTask; capture by reference");
+        static_assert(alignof(Fn) <= alignof(max_align_t), "task capture over-aligned for PoolTask");
+        new (storage) Fn(std::forward<F>(f));
+        ops = &opsFor<Fn>::table;
+    }
+
+    PoolTask(PoolTask &&other) noexcept : ops(other.ops) {
+        if (ops) {
+            ops->move(other.storage, storage);
+            other.ops = nullptr;
+        }
+    }
+
+    PoolTask& operator=(PoolTask &&other) noexcept {
+        if (this != &other) {
+            reset();
+            ops = other.ops;
+            if (ops) {
+                ops->move(other.storage, storage);
+                other.ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    PoolTask(const PoolTask&) = delete;
+    PoolTask& operator=(const PoolTask&) = delete;
+    ~PoolTask() { reset(); }
+
+    explicit operator bool() const { return ops != nullptr; }
+    void operator()() { ops->invoke(storage); }
+
+    void reset() {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void*);
+        void (*move)(void *from, void *to);   // move-constructs into `to`, destroys `from`
+        void (*destroy)(void*);
+    };
+
+    template <typename Fn>
+    struct opsFor {
+        static void invoke(void *p) { (*static_cast<Fn*>(p))(); }
+        static void move(void *from, void *to) {
+            new (to) Fn(std::move(*static_cast<Fn*>(from)));
+            static_cast<Fn*>(from)->~Fn();
+        }
+        static void destroy(void *p) { static_cast<Fn*>(p)->~Fn(); }
+        static const Ops table;
+    };
+
+    alignas(max_align_t) unsigned char storage[kInlineSize];
+    const Ops *ops;
+};
+
+template <typename Fn>
+const typename PoolTask::Ops PoolTask::opsFor<Fn>::table = {
+    &PoolTask::opsFor<Fn>::invoke, &PoolTask::opsFor<Fn>::move, &PoolTask::opsFor<Fn>::destroy
+};
+
 class ThreadPool {
 private:
     vector<thread> workers;
-    queue<function<void()>> tasks;
+
+    // FIFO ring of recycled task slots; it only grows (doubling) when full, so
+    // once it has reached the block's peak width no submission allocates
+    vector<PoolTask> ring;
+    size_t head;
+    size_t count;
 
     mutex queueMutex;
     condition_variable condition;
     bool stop;
 
     atomic<size_t> activeTasks;
+    atomic<size_t> queuedTasks;   // mirrors count for lock-free sampling
+    int liveStatsSource;
+
+    void push(PoolTask &&task);
 
 public:
     ThreadPool(size_t threads);
-    void enqueue(function<void()> task);
+
+    template <typename F>
+    void enqueue(F &&f) { push(PoolTask(std::forward<F>(f))); }
+
+    // plain (function, context, index) task, e.g. one transaction of a level
+    void enqueue(void (*fn)(void *ctx, size_t index), void *ctx, size_t index);
+
+    // pre-size the ring so the first burst of `tasks` submissions does not grow it
+    void reserve(size_t tasks);
+
     void waitAll(); // waits until both queue empty and active tasks 0
     ~ThreadPool();
 };
 
-#endif // THREAD_POOL_H
\ No newline at end of file
+#endif // THREAD_POOL_H
@@ -3,6 +3,8 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <chrono>
+#include <unordered_map>
 
 class TraceWriter {
 public:
@@ -11,11 +13,81 @@ public:
     // Add a JSON-formatted event string (already escaped)
     void pushEvent(const std::string &jsonEvent);
 
-    // Write collected events into a file path as a JSON array
+    // Write collected events into a file path as a JSON array.
+    // In chunked mode this is close(): the events are already on disk.
     void flushToFile(const std::string &path);
 
+    // Chunked mode: every `eventsPerChunk` events are stamped with "ts" (us since
+    // open) and written to <dir>/chunk_NNNNN.json while the run is going, and
+    // <dir>/index.json lists each chunk's event, time and batch range. Each
+    // chunk also gets <dir>/keyframe_NNNNN.json with the node states just before
+    // its first event. Most keyframes are deltas: only the nodes the previous
+    // chunk changed. A full keyframe is written once the deltas since the last
+    // one add up to its size, so keyframes cost at most about as much disk as the
+    // events, and a viewer seeks by applying one full keyframe and the deltas
+    // after it. Memory stays at one chunk plus one state per node.
+    bool openChunked(const std::string &dir, size_t eventsPerChunk = 4096);
+
+    // Writes the last partial chunk and marks the index complete
+    void close();
+    bool isChunked() const {
+        std::lock_guard<std::mutex> lg(m);
+        return chunked;
+    }
+
 private:
     TraceWriter() = default;
     std::vector<std::string> events;
-    std::mutex m;
+    mutable std::mutex m;
+
+    // Node states as the GUI derives them from events, keyed by the escaped tx id
+    struct NodeStates {
+        std::unordered_map<std::string, const char*> state;   // "ready", "running" or "done"
+        std::unordered_map<std::string, std::string> thread;  // last thread that evaluated it
+    };
+
+    struct ChunkInfo {
+        std::string file;
+        std::string keyframe;
+        bool fullKeyframe = false;
+        size_t firstEvent = 0;
+        size_t events = 0;
+        long long tStartUs = 0, tEndUs = 0;
+        long long firstBatch = 0, lastBatch = 0;
+    };
+    struct SealedChunk {
+        ChunkInfo info;
+        std::vector<std::string> events;
+        NodeStates changed;      // by this chunk's events
+    };
+
+    SealedChunk sealChunk();                       // holds m
+    void trackNodeStates(const std::string &ev);   // holds m
+    void writePending(bool complete);              // takes writeMutex, then m briefly
+    void writeChunk(const SealedChunk &chunk);     // holds writeMutex
+    void writeKeyframe(const std::string &file, const NodeStates &states, bool full);
+    void writeIndex(bool complete);                // holds writeMutex
+
+    bool chunked = false;
+    std::string dir;
+    size_t perChunk = 4096;
+    std::chrono::steady_clock::time_point origin;
+    size_t sealedEvents = 0;        // events already handed to writeChunk
+    size_t chunkCount = 0;
+    long long currentBatch = 0;     // last batchId seen, inherited by tx events
+    long long chunkStartUs = 0, chunkFirstBatch = 0, lastUs = 0;
+    NodeStates changed;             // by the open chunk's events so far
+    std::vector<SealedChunk> pending;   // sealed under m, not yet taken by a writer
+
+    // Serialises chunk and index writes. Lock order is writeMutex, then m, and m
+    // is never held while waiting for writeMutex, so a pusher that fills a chunk
+    // never blocks the others on file I/O.
+    std::mutex writeMutex;
+    std::vector<ChunkInfo> index;
+    // writer side, under writeMutex: states after the chunks written so far, the
+    // last chunk's changes (the next keyframe if it is a delta), and the entries
+    // written as deltas since the last full keyframe
+    NodeStates writtenNodes;
+    NodeStates lastChanged;
+    size_t deltaEntries = 0;
 };
@@ -0,0 +1,48 @@
+// TxDelta.h
+#ifndef TX_DELTA_H
+#define TX_DELTA_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <stdexcept>
+using namespace std;
+
+// Effect of one transaction: key -> balance change. The transfer semantics
+// touch at most two keys, so they are held inline and evaluating a
+// transaction never allocates (key names fit the small-string buffer).
+// Iterates like a map; lookups are linear over the two slots.
+class TxDelta {
+public:
+    using value_type = pair<string, long long>;
+    static const size_t kMaxKeys = 2;
+
+    long long& operator[](const string &key) {
+        for (size_t i = 0; i < n; ++i)
+            if (slots[i].first == key) return slots[i].second;
+        if (n == kMaxKeys) throw length_error("TxDelta holds at most " + to_string(kMaxKeys) + " keys");
+        slots[n].first = key;
+        slots[n].second = 0;
+        return slots[n++].second;
+    }
+    size_t count(const string &key) const {
+        for (size_t i = 0; i < n; ++i)
+            if (slots[i].first == key) return 1;
+        return 0;
+    }
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    void clear() { n = 0; }   // slots keep their strings' buffers for reuse
+
+    const value_type* begin() const { return slots; }
+    const value_type* end() const { return slots + n; }
+
+private:
+    value_type slots[kMaxKeys];
+    size_t n = 0;
+};
+
+// Merged effect of many transactions (a group, a chunk, the out-of-core level)
+using StateDelta = unordered_map<string, long long>;
+
+#endif // TX_DELTA_H
@@ -2,6 +2,7 @@
 #define UTILS_H
 
 #include <vector>
+#include <functional>
 #include "Transaction.h"
 #include "State.h"
 using namespace std;
@@ -12,4 +13,16 @@ vector<Transaction> createSampleTransactions();
 // Creates an initial state (balances) for the demo
 State createInitialState();
 
+// Benchmark generator: `count` transfers over accounts K0..K{keyCount-1}.
+// A `hotKeyRatio` share of them read from K0, which creates conflict skew.
+vector<Transaction> createSyntheticTransactions(size_t count, size_t keyCount, double hotKeyRatio, unsigned seed);
+
+// Same sequence, handed over one transaction at a time so blocks larger than
+// memory can be streamed (out-of-core mode)
+void forEachSyntheticTransaction(size_t count, size_t keyCount, double hotKeyRatio, unsigned seed,
+                                 const function<void(const Transaction &)> &fn);
+
+// Every synthetic account starts with the same balance
+State createSyntheticState(size_t keyCount, long long initialBalance);
+
 #endif // UTILS_H
\ No newline at end of file
@@ -0,0 +1,68 @@
+// AllocCounter.cpp
+#include "AllocCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+using namespace std;
+
+#ifdef DIPETRANS_COUNT_ALLOCS
+
+static atomic<uint64_t> gAllocations(0);
+
+bool allocationCountingEnabled() { return true; }
+uint64_t allocationCount() { return gAllocations.load(memory_order_relaxed); }
+
+static void* countedAlloc(size_t size) {
+    gAllocations.fetch_add(1, memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+static void* countedAlignedAlloc(size_t size, align_val_t al) {
+    gAllocations.fetch_add(1, memory_order_relaxed);
+    size_t a = static_cast<size_t>(al);
+    // aligned_alloc wants a size that is a multiple of the alignment
+    size_t rounded = (size + a - 1) / a * a;
+    return aligned_alloc(a, rounded ? rounded : a);
+}
+
+void* operator new(size_t size) {
+    if (void *p = countedAlloc(size)) return p;
+    throw bad_alloc();
+}
+void* operator new[](size_t size) {
+    if (void *p = countedAlloc(size)) return p;
+    throw bad_alloc();
+}
+void* operator new(size_t size, const nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return countedAlloc(size); }
+
+void* operator new(size_t size, align_val_t al) {
+    if (void *p = countedAlignedAlloc(size, al)) return p;
+    throw bad_alloc();
+}
+void* operator new[](size_t size, align_val_t al) {
+    if (void *p = countedAlignedAlloc(size, al)) return p;
+    throw bad_alloc();
+}
+void* operator new(size_t size, align_val_t al, const nothrow_t&) noexcept { return countedAlignedAlloc(size, al); }
+void* operator new[](size_t size, align_val_t al, const nothrow_t&) noexcept { return countedAlignedAlloc(size, al); }
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+void operator delete(void *p, const nothrow_t&) noexcept { free(p); }
+void operator delete[](void *p, const nothrow_t&) noexcept { free(p); }
+void operator delete(void *p, align_val_t) noexcept { free(p); }
+void operator delete[](void *p, align_val_t) noexcept { free(p); }
+void operator delete(void *p, size_t, align_val_t) noexcept { free(p); }
+void operator delete[](void *p, size_t, align_val_t) noexcept { free(p); }
+void operator delete(void *p, align_val_t, const nothrow_t&) noexcept { free(p); }
+void operator delete[](void *p, align_val_t, const nothrow_t&) noexcept { free(p); }
+
+#else
+
+bool allocationCountingEnabled() { return false; }
+uint64_t allocationCount() { return 0; }
+
+#endif // DIPETRANS_COUNT_ALLOCS
@@ -0,0 +1,131 @@
+// BlockStats.cpp
+#include "BlockStats.h"
+#include <unordered_map>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdint>
+using namespace std;
+
+string BlockStats::summary() const {
+    ostringstream o;
+    o << fixed << setprecision(4)
+      << "txs=" << txCount
+      << " edges=" << edgeCount
+      << " density=" << conflictDensity
+      << " depth=" << longestPath
+      << " maxWidth=" << maxWidth
+      << " avgWidth=" << setprecision(2) << avgWidth
+      << " components=" << componentCount
+      << " largestComponent=" << largestComponent
+      << " skew=" << setprecision(4) << hotKeySkew;
+    if (!hottestKey.empty()) o << " hotKey=" << hottestKey;
+    return o.str();
+}
+
+namespace {
+
+struct KeyStats {
+    size_t lastWrite = 0;           // level + 1 of the latest writer, 0 = never written
+    size_t maxRead = 0;             // level + 1 of the deepest reader so far
+    size_t touches = 0;
+    size_t writer = SIZE_MAX;       // any writer: every later toucher conflicts with it
+    vector<size_t> earlyReaders;    // readers before the first write, joined to it
+};
+
+size_t findRoot(vector<size_t> &parent, size_t x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+void unite(vector<size_t> &parent, size_t a, size_t b) {
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a != b) parent[max(a, b)] = min(a, b);
+}
+
+} // namespace
+
+BlockStats computeBlockStats(const DAG &dag, const vector<Transaction> &txs) {
+    BlockStats s;
+    s.txCount = txs.size();
+
+    for (auto &p : dag.getAdjList()) s.edgeCount += p.second.size();
+    if (s.txCount > 1) {
+        double pairs = (double)s.txCount * (double)(s.txCount - 1) / 2.0;
+        s.conflictDensity = (double)s.edgeCount / pairs;
+    }
+
+    // The DAG joins every conflicting pair from the earlier to the later
+    // transaction, so its Kahn levels, its components and the key touch counts
+    // all follow from one block-order pass over the read/write sets. That hashes
+    // each key access once instead of every edge endpoint.
+    const size_t n = txs.size();
+    unordered_map<string, KeyStats> keys;
+    vector<size_t> parent(n);
+    for (size_t i = 0; i < n; ++i) parent[i] = i;
+    vector<KeyStats*> reads, writes;
+
+    for (size_t i = 0; i < n; ++i) {
+        const Transaction &tx = txs[i];
+        reads.clear();
+        writes.clear();
+        size_t level = 0;
+        for (auto &k : tx.getReadSet()) {
+            KeyStats &ks = keys[k];
+            ks.touches++;   // count each key at most once per transaction
+            level = max(level, ks.lastWrite);
+            reads.push_back(&ks);
+        }
+        for (auto &k : tx.getWriteSet()) {
+            KeyStats &ks = keys[k];
+            if (!tx.getReadSet().count(k)) ks.touches++;
+            level = max({level, ks.lastWrite, ks.maxRead});
+            writes.push_back(&ks);
+        }
+
+        for (KeyStats *ks : reads) {
+            ks->maxRead = max(ks->maxRead, level + 1);
+            if (ks->writer != SIZE_MAX) unite(parent, i, ks->writer);
+            else ks->earlyReaders.push_back(i);
+        }
+        for (KeyStats *ks : writes) {
+            ks->lastWrite = level + 1;
+            if (ks->writer == SIZE_MAX) {
+                ks->writer = i;
+                for (size_t r : ks->earlyReaders) unite(parent, i, r);
+                vector<size_t>().swap(ks->earlyReaders);
+            } else {
+                unite(parent, i, ks->writer);
+            }
+        }
+
+        if (level >= s.levelWidths.size()) s.levelWidths.resize(level + 1, 0);
+        s.levelWidths[level]++;
+    }
+
+    s.longestPath = s.levelWidths.size();
+    for (size_t w : s.levelWidths) s.maxWidth = max(s.maxWidth, w);
+    if (s.longestPath > 0) s.avgWidth = (double)s.txCount / (double)s.longestPath;
+
+    vector<size_t> componentSize(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        size_t root = findRoot(parent, i);
+        if (componentSize[root]++ == 0) s.componentCount++;
+        s.largestComponent = max(s.largestComponent, componentSize[root]);
+    }
+
+    size_t hottest = 0;
+    for (auto &p : keys) {
+        if (p.second.touches > hottest) {
+            hottest = p.second.touches;
+            s.hottestKey = p.first;
+        }
+    }
+    if (s.txCount > 0) s.hotKeySkew = (double)hottest / (double)s.txCount;
+
+    return s;
+}
@@ -0,0 +1,116 @@
+// Coarsening.cpp
+#include "Coarsening.h"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+size_t coarseTaskSize(const CoarseningPolicy &policy, double txNs) {
+    if (txNs <= 0.0) return 1;
+    double n = floor((double)policy.targetTaskNs / txNs);
+    if (n < 1.0) return 1;
+    return min(policy.maxTxsPerTask, (size_t)n);
+}
+
+CoarsePlan coarsenSchedule(const IndexedDAG &g, size_t txsPerTask, size_t threads) {
+    const size_t n = g.size();
+    const size_t none = (size_t)-1;
+    CoarsePlan plan;
+    if (txsPerTask == 0) txsPerTask = 1;
+    if (threads == 0) threads = 1;
+
+    vector<int> indeg(n, 0);
+    vector<size_t> onlyPred(n, none);
+    for (size_t u = 0; u < n; ++u) {
+        for (size_t v : g.successors(u)) {
+            indeg[v]++;
+            onlyPred[v] = u;
+        }
+    }
+
+    // chain contraction: v extends u's chain when the edge u→v is the only way out of u and into v.
+    // Unit a is unitTxs[unitStarts[a] .. unitStarts[a + 1]).
+    auto extendsChain = [&](size_t v) {
+        return indeg[v] == 1 && g.successors(onlyPred[v]).size() == 1;
+    };
+    vector<size_t> unitOf(n, none);
+    vector<size_t> unitTxs, unitStarts;
+    unitTxs.reserve(n);
+    for (size_t head = 0; head < n; ++head) {
+        if (extendsChain(head)) continue;
+        size_t unit = unitStarts.size();
+        unitStarts.push_back(unitTxs.size());
+        size_t cur = head;
+        while (true) {
+            unitOf[cur] = unit;
+            unitTxs.push_back(cur);
+            IndexRange next = g.successors(cur);
+            if (next.size() != 1 || !extendsChain(next[0])) break;
+            cur = next[0];
+        }
+        size_t length = unitTxs.size() - unitStarts.back();
+        if (length > 1) {
+            plan.chains++;
+            plan.chainedTxs += length;
+        }
+    }
+    unitStarts.push_back(unitTxs.size());
+    const size_t u = unitStarts.size() - 1;
+    plan.units = u;
+    auto unitSize = [&](size_t a) { return unitStarts[a + 1] - unitStarts[a]; };
+
+    // unit edges leave from a chain's tail only
+    IndexedDAG unitSucc;
+    unitSucc.offsets.assign(u + 1, 0);
+    for (size_t a = 0; a < u; ++a)
+        unitSucc.offsets[a + 1] = unitSucc.offsets[a] + g.successors(unitTxs[unitStarts[a + 1] - 1]).size();
+    unitSucc.targets.reserve(unitSucc.offsets[u]);
+    for (size_t a = 0; a < u; ++a)
+        for (size_t v : g.successors(unitTxs[unitStarts[a + 1] - 1])) unitSucc.targets.push_back(unitOf[v]);
+
+    // Kahn levels over units: units of one level share no edge, so any subset
+    // of them can run back to back inside one task
+    LevelOrder levels = topologicalLevels(unitSucc);
+
+    vector<size_t> taskOf(u, none);
+    plan.taskTxs.reserve(n);
+    for (size_t l = 0; l < levels.levels(); ++l) {
+        IndexRange level = levels.level(l);
+        size_t levelTxs = 0;
+        for (size_t a : level) levelTxs += unitSize(a);
+        size_t cap = min(txsPerTask, max<size_t>(1, (levelTxs + threads - 1) / threads));
+
+        size_t openUnits = 0;
+        for (size_t a : level) {
+            if (openUnits == 0 || plan.taskTxs.size() - plan.taskStarts.back() + unitSize(a) > cap) {
+                if (openUnits > 1) plan.packedTasks++;
+                plan.taskStarts.push_back(plan.taskTxs.size());
+                openUnits = 0;
+            }
+            plan.taskTxs.insert(plan.taskTxs.end(), unitTxs.begin() + unitStarts[a], unitTxs.begin() + unitStarts[a + 1]);
+            taskOf[a] = plan.taskStarts.size() - 1;
+            openUnits++;
+        }
+        if (openUnits > 1) plan.packedTasks++;
+    }
+    plan.taskStarts.push_back(plan.taskTxs.size());
+    const size_t tasks = plan.taskCount();
+
+    // task edges: every unit edge lifted to its tasks, then deduplicated
+    vector<pair<size_t, size_t>> edges;
+    edges.reserve(unitSucc.edgeCount());
+    for (size_t a = 0; a < u; ++a)
+        for (size_t b : unitSucc.successors(a)) edges.emplace_back(taskOf[a], taskOf[b]);
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+    plan.succ.offsets.assign(tasks + 1, 0);
+    plan.succ.targets.reserve(edges.size());
+    plan.indeg.assign(tasks, 0);
+    for (auto &e : edges) {
+        plan.succ.offsets[e.first + 1]++;
+        plan.succ.targets.push_back(e.second);
+        plan.indeg[e.second]++;
+    }
+    for (size_t t = 0; t < tasks; ++t) plan.succ.offsets[t + 1] += plan.succ.offsets[t];
+    return plan;
+}
@@ -0,0 +1,141 @@
+// Components.cpp
+#include "Components.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <memory>
+#include <algorithm>
+using namespace std;
+
+namespace {
+
+// Concurrent union-find: roots always link towards the smaller index, so the
+// parent forest stays acyclic without locks; find() halves paths as it walks.
+class ConcurrentUnionFind {
+private:
+    unique_ptr<atomic<size_t>[]> parent;
+
+public:
+    explicit ConcurrentUnionFind(size_t n) : parent(new atomic<size_t>[n]) {
+        for (size_t i = 0; i < n; ++i) parent[i].store(i, memory_order_relaxed);
+    }
+
+    size_t find(size_t x) {
+        while (true) {
+            size_t p = parent[x].load(memory_order_acquire);
+            if (p == x) return x;
+            size_t gp = parent[p].load(memory_order_acquire);
+            if (gp != p) parent[x].compare_exchange_weak(p, gp, memory_order_acq_rel);
+            x = gp;
+        }
+    }
+
+    void unite(size_t a, size_t b) {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b) return;
+            if (a < b) swap(a, b);
+            size_t expected = a;
+            if (parent[a].compare_exchange_strong(expected, b, memory_order_acq_rel)) return;
+        }
+    }
+};
+
+} // namespace
+
+size_t ComponentSet::largest() const {
+    size_t best = 0;
+    for (size_t c = 0; c < count(); ++c) best = max(best, size(c));
+    return best;
+}
+
+size_t ComponentSet::maxDepth() const {
+    size_t best = 0;
+    for (size_t d : depths) best = max(best, d);
+    return best;
+}
+
+ComponentSet findConnectedComponents(const IndexedDAG &g, size_t threads) {
+    const size_t n = g.size();
+    const size_t none = (size_t)-1;
+
+    ConcurrentUnionFind uf(n);
+    const size_t edges = g.edgeCount();
+    auto uniteEdges = [&g, &uf](size_t begin, size_t end) {
+        // source of edge `begin`: the last node whose successors start at or before it
+        size_t u = (size_t)(upper_bound(g.offsets.begin(), g.offsets.end(), begin) - g.offsets.begin()) - 1;
+        for (size_t e = begin; e < end; ++e) {
+            while (g.offsets[u + 1] <= e) ++u;
+            uf.unite(u, g.targets[e]);
+        }
+    };
+    if (threads <= 1 || edges < 4096) {
+        uniteEdges(0, edges);
+    } else {
+        ThreadPool pool(threads);
+        size_t chunk = (edges + threads - 1) / threads;
+        for (size_t begin = 0; begin < edges; begin += chunk) {
+            size_t end = min(edges, begin + chunk);
+            pool.enqueue([&uniteEdges, begin, end]() { uniteEdges(begin, end); });
+        }
+        pool.waitAll();
+    }
+
+    // Kahn levels give a global topological order; a node's level is also its
+    // depth inside its own component, because no path leaves a component.
+    LevelOrder levels = topologicalLevels(g);
+
+    ComponentSet set;
+    vector<size_t> componentOfRoot(n, none), componentOf(n, none);
+    set.starts.push_back(0);
+    for (size_t l = 0; l < levels.levels(); ++l) {
+        for (size_t p : levels.level(l)) {
+            size_t &c = componentOfRoot[uf.find(p)];
+            if (c == none) {
+                c = set.depths.size();
+                set.depths.push_back(0);
+                set.starts.push_back(0);
+            }
+            componentOf[p] = c;
+            set.starts[c + 1]++;
+            set.depths[c] = max(set.depths[c], l + 1);
+        }
+    }
+    for (size_t c = 0; c < set.count(); ++c) set.starts[c + 1] += set.starts[c];
+
+    // walk nodes in topological order again, so every component keeps that order
+    set.order.resize(levels.order.size());
+    vector<size_t> cursor(set.starts.begin(), set.starts.end() - 1);
+    for (size_t p : levels.order) set.order[cursor[componentOf[p]]++] = p;
+    return set;
+}
+
+vector<vector<size_t>> packComponents(const ComponentSet &set, size_t targetTxs) {
+    if (targetTxs == 0) targetTxs = 1;
+
+    vector<size_t> bySize(set.count());
+    for (size_t i = 0; i < bySize.size(); ++i) bySize[i] = i;
+    sort(bySize.begin(), bySize.end(), [&](size_t a, size_t b) {
+        return set.size(a) > set.size(b);
+    });
+
+    vector<vector<size_t>> units;
+    vector<size_t> current;
+    size_t currentTxs = 0;
+    for (size_t c : bySize) {
+        size_t size = set.size(c);
+        if (size >= targetTxs) {
+            units.push_back({c});
+            continue;
+        }
+        current.push_back(c);
+        currentTxs += size;
+        if (currentTxs >= targetTxs) {
+            units.push_back(move(current));
+            current.clear();
+            currentTxs = 0;
+        }
+    }
+    if (!current.empty()) units.push_back(move(current));
+    return units;
+}
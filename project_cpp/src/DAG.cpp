@@ -1,6 +1,8 @@
 #include "DAG.h"
 #include <iostream>
 #include <unordered_set>
+#include <algorithm>
+#include <functional>
 using namespace std;
 
 void DAG::addNode(const string &id) {
@@ -20,40 +22,55 @@ void DAG::addEdge(const string &from, const string &to) {
     indegree[to]++;
 }
 
+void DAG::removeEdge(const string &from, const string &to) {
+    auto it = adj.find(from);
+    if (it == adj.end()) return;
+    auto &vec = it->second;
+    for (size_t i = 0; i < vec.size(); i++) {
+        if (vec[i] == to) {
+            vec.erase(vec.begin() + i);
+            indegree[to]--;
+            return;
+        }
+    }
+}
+
+void DAG::removeNode(const string &id) {
+    auto it = adj.find(id);
+    if (it == adj.end()) return;
+    for (const string &to : it->second) indegree[to]--;
+    adj.erase(it);
+    indegree.erase(id);
+}
+
 void DAG::buildFromTransactions(const vector<Transaction> &txs) {
     // Add all nodes
     for (const auto &tx : txs) addNode(tx.getId());
 
-    // Build dependencies safely
+    // Build dependencies safely. Every conflicting pair is ordered by block
+    // position (earlier → later), which is the serial order the parallel run
+    // must reproduce. Ordering some pairs writer-first instead lets chains like
+    // A→B→C→A form, and those transactions never become ready.
     for (size_t i = 0; i < txs.size(); i++) {
-        for (size_t j = 0; j < txs.size(); j++) {
-            if (i == j) continue;
-
+        for (size_t j = i + 1; j < txs.size(); j++) {
             const Transaction &A = txs[i];
             const Transaction &B = txs[j];
 
-            bool A_to_B = false;
-            bool B_to_A = false;
+            bool conflict = false;
 
-            // Rule 1: A.write ∩ B.read → A→B
+            // Rule 1: A.write ∩ B.read  (read-after-write)
             for (auto &w : A.getWriteSet())
-                if (B.getReadSet().count(w)) A_to_B = true;
+                if (B.getReadSet().count(w)) conflict = true;
 
-            // Rule 2: A.write ∩ B.write → A→B
+            // Rule 2: A.write ∩ B.write (write-after-write)
             for (auto &w : A.getWriteSet())
-                if (B.getWriteSet().count(w)) A_to_B = true;
+                if (B.getWriteSet().count(w)) conflict = true;
 
-            // Rule 3: A.read ∩ B.write → B→A
+            // Rule 3: A.read ∩ B.write  (write-after-read)
             for (auto &r : A.getReadSet())
-                if (B.getWriteSet().count(r)) B_to_A = true;
+                if (B.getWriteSet().count(r)) conflict = true;
 
-            // Apply edges
-            if (A_to_B && !B_to_A) addEdge(A.getId(), B.getId());
-            if (B_to_A && !A_to_B) addEdge(B.getId(), A.getId());
-
-            // Very rare case: both true → prefer write-order
-            if (A_to_B && B_to_A)
-                addEdge(A.getId(), B.getId());
+            if (conflict) addEdge(A.getId(), B.getId());
         }
     }
 }
@@ -72,4 +89,95 @@ vector<string> DAG::getAllNodes() const {
     nodes.reserve(adj.size());
     for (auto &p : adj) nodes.push_back(p.first);
     return nodes;
-}
\ No newline at end of file
+}
+
+vector<vector<string>> DAG::getLevels() const {
+    unordered_map<string, int> remaining = indegree;
+    vector<vector<string>> levels;
+
+    vector<string> frontier;
+    for (auto &p : adj)
+        if (remaining[p.first] == 0) frontier.push_back(p.first);
+
+    while (!frontier.empty()) {
+        vector<string> next;
+        for (auto &id : frontier) {
+            auto it = adj.find(id);
+            if (it == adj.end()) continue;
+            for (auto &to : it->second)
+                if (--remaining[to] == 0) next.push_back(to);
+        }
+        levels.push_back(move(frontier));
+        frontier = move(next);
+    }
+    return levels;
+}
+
+IndexedDAG indexDAG(const DAG &dag, const vector<Transaction> &txs) {
+    const size_t n = txs.size();
+    const size_t none = (size_t)-1;
+
+    // id -> position, open addressing at most half full
+    size_t capacity = 1;
+    while (capacity < 2 * n) capacity <<= 1;
+    const size_t mask = capacity - 1;
+    vector<size_t> slots(capacity, none);
+    hash<string> hasher;
+    for (size_t i = 0; i < n; ++i) {
+        size_t h = hasher(txs[i].getId()) & mask;
+        while (slots[h] != none) h = (h + 1) & mask;
+        slots[h] = i;
+    }
+    auto position = [&](const string &id) {
+        for (size_t h = hasher(id) & mask; slots[h] != none; h = (h + 1) & mask)
+            if (txs[slots[h]].getId() == id) return slots[h];
+        return none;
+    };
+
+    size_t edges = 0;
+    for (auto &p : dag.getAdjList()) edges += p.second.size();
+    vector<pair<size_t, size_t>> pairs;
+    pairs.reserve(edges);
+    for (auto &p : dag.getAdjList()) {
+        size_t from = position(p.first);
+        if (from == none) continue;
+        for (auto &to : p.second) {
+            size_t t = position(to);
+            if (t != none) pairs.emplace_back(from, t);
+        }
+    }
+
+    // counting sort by source; each node keeps its adjacency-list order
+    IndexedDAG g;
+    g.offsets.assign(n + 1, 0);
+    for (auto &e : pairs) g.offsets[e.first + 1]++;
+    for (size_t i = 0; i < n; ++i) g.offsets[i + 1] += g.offsets[i];
+    g.targets.resize(pairs.size());
+    vector<size_t> cursor(g.offsets.begin(), g.offsets.end() - 1);
+    for (auto &e : pairs) g.targets[cursor[e.first]++] = e.second;
+    return g;
+}
+
+LevelOrder topologicalLevels(const IndexedDAG &g) {
+    const size_t n = g.size();
+    vector<size_t> remaining(n, 0);
+    for (size_t t : g.targets) remaining[t]++;
+
+    LevelOrder levels;
+    levels.order.reserve(n);
+    levels.starts.push_back(0);
+    for (size_t i = 0; i < n; ++i)
+        if (remaining[i] == 0) levels.order.push_back(i);
+
+    size_t begin = 0;
+    while (begin < levels.order.size()) {
+        size_t end = levels.order.size();
+        levels.starts.push_back(end);
+        for (size_t k = begin; k < end; ++k)
+            for (size_t s : g.successors(levels.order[k]))
+                if (--remaining[s] == 0) levels.order.push_back(s);
+        sort(levels.order.begin() + end, levels.order.end());
+        begin = end;
+    }
+    return levels;
+}
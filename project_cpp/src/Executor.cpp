@@ -3,6 +3,9 @@
 #include "Metrics.h"
 #include "ExecutionObserver.h"
 #include "TraceWriter.h"
+#include "Components.h"
+#include "Partitioner.h"
+#include "LiveStats.h"
 
 #include <iostream>
 #include <queue>
@@ -12,88 +15,143 @@
 #include <unordered_map>
 #include <functional>
 #include <sstream>
-#include <iomanip>
+#include <cstdio>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <deque>
 
 using namespace std;
 
 static mutex coutMutex;
 
-static bool transactionsConflict(const Transaction &A, const Transaction &B) {
-    for (const auto &w : A.getWriteSet()) {
-        if (B.getReadSet().count(w)) return true;
+string executionModeName(ExecutionMode mode) {
+    switch (mode) {
+        case ExecutionMode::Sequential: return "sequential";
+        case ExecutionMode::ParallelBatches: return "batches";
+        case ExecutionMode::BatchThreads: return "threads";
+        case ExecutionMode::PriorityBatches: return "priority";
+        case ExecutionMode::ThreadPoolBatches: return "pool";
+        case ExecutionMode::Waves: return "waves";
+        case ExecutionMode::DependencyDriven: return "dependency";
+        case ExecutionMode::Components: return "components";
+        case ExecutionMode::Coarsened: return "coarse";
     }
-    for (const auto &w : A.getWriteSet()) {
-        if (B.getWriteSet().count(w)) return true;
-    }
-    for (const auto &r : A.getReadSet()) {
-        if (B.getWriteSet().count(r)) return true;
+    return "unknown";
+}
+
+vector<ExecutionMode> allExecutionModes() {
+    return {
+        ExecutionMode::Sequential,
+        ExecutionMode::ParallelBatches,
+        ExecutionMode::BatchThreads,
+        ExecutionMode::PriorityBatches,
+        ExecutionMode::ThreadPoolBatches,
+        ExecutionMode::Waves,
+        ExecutionMode::DependencyDriven,
+        ExecutionMode::Components,
+        ExecutionMode::Coarsened
+    };
+}
+
+bool parseExecutionMode(const string &name, ExecutionMode &mode) {
+    for (ExecutionMode m : allExecutionModes()) {
+        if (executionModeName(m) == name) {
+            mode = m;
+            return true;
+        }
     }
     return false;
 }
 
-static vector<vector<string>> partitionIntoConflictFreeGroups(
-    const vector<string> &batch,
-    const unordered_map<string, Transaction> &lookup
-) {
-    vector<vector<string>> groups;
-    for (const auto &txid : batch) {
-        const Transaction &tx = lookup.at(txid);
-        bool placed = false;
-        for (auto &group : groups) {
-            bool conflict_with_group = false;
-            for (const auto &memberId : group) {
-                const Transaction &memberTx = lookup.at(memberId);
-                if (transactionsConflict(tx, memberTx) || transactionsConflict(memberTx, tx)) {
-                    conflict_with_group = true;
-                    break;
-                }
-            }
-            if (!conflict_with_group) {
-                group.push_back(txid);
-                placed = true;
-                break;
-            }
-        }
-        if (!placed) groups.push_back(vector<string>{txid});
+// Demo transfer semantics: one unit moves from the first read key to the first write key
+TxDelta evaluateTransaction(const Transaction &t) {
+    static const string none;
+    return evaluateTransfer(t.getReadSet().empty() ? none : *t.getReadSet().begin(),
+                            t.getWriteSet().empty() ? none : *t.getWriteSet().begin());
+}
+
+TxDelta evaluateTransfer(const string &from, const string &to) {
+    TxDelta delta;
+    if (!from.empty() && !to.empty()) {
+        delta[from]--;
+        delta[to]++;
     }
-    return groups;
+    return delta;
+}
+
+// Live-stats latency runs from dispatch (enqueue, or the start of a level or
+// group) to the delta reaching the state. 0 = no segment open, no clock read.
+static uint64_t liveDispatchNs() {
+    if (!LiveStats::get().isOpen()) return 0;
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void liveApplied(uint64_t dispatchedNs, uint64_t txs = 1) {
+    if (dispatchedNs == 0 || txs == 0) return;
+    uint64_t now = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+    LiveStats::get().txCompleted(now - dispatchedNs, txs);
+}
+
+// formatted once per thread; the hash runs to 20 digits, past the small-string buffer
+static const string &currentThreadIdString() {
+    thread_local const string id = to_string(hash<thread::id>{}(this_thread::get_id()));
+    return id;
 }
 
 // ---- JSON helpers for trace events ----
-static std::string escapeJsonString(const std::string &s) {
-    std::ostringstream o;
+// Append to `o` so the per-transaction events can be built in a reused buffer
+static void appendJsonEscaped(std::string &o, const std::string &s) {
     for (auto c : s) {
         switch (c) {
-            case '\"': o << "\\\""; break;
-            case '\\': o << "\\\\"; break;
-            case '\b': o << "\\b"; break;
-            case '\f': o << "\\f"; break;
-            case '\n': o << "\\n"; break;
-            case '\r': o << "\\r"; break;
-            case '\t': o << "\\t"; break;
+            case '\"': o += "\\\""; break;
+            case '\\': o += "\\\\"; break;
+            case '\b': o += "\\b"; break;
+            case '\f': o += "\\f"; break;
+            case '\n': o += "\\n"; break;
+            case '\r': o += "\\r"; break;
+            case '\t': o += "\\t"; break;
             default:
                 if (static_cast<unsigned char>(c) <= 0x1f) {
-                    o << "\\u"
-                      << std::hex << std::setw(4) << std::setfill('0') << (int)c;
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", (int)c);
+                    o += buf;
                 } else {
-                    o << c;
+                    o += c;
                 }
         }
     }
-    return o.str();
 }
 
-static std::string deltaToJson(const unordered_map<string, long long> &d) {
-    std::ostringstream o;
-    o << "{";
+template <class Delta>
+static void appendDeltaJson(std::string &o, const Delta &d) {
+    o += "{";
     bool first = true;
     for (const auto &p : d) {
-        if (!first) o << ",";
+        if (!first) o += ",";
         first = false;
-        o << "\"" << escapeJsonString(p.first) << "\":" << p.second;
+        o += "\"";
+        appendJsonEscaped(o, p.first);
+        char buf[24];
+        snprintf(buf, sizeof(buf), "\":%lld", (long long)p.second);
+        o += buf;
     }
-    o << "}";
-    return o.str();
+    o += "}";
+}
+
+static std::string escapeJsonString(const std::string &s) {
+    std::string o;
+    appendJsonEscaped(o, s);
+    return o;
+}
+
+template <class Delta>
+static std::string deltaToJson(const Delta &d) {
+    std::string o;
+    appendDeltaJson(o, d);
+    return o;
 }
 
 void Executor::executeWithState(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics) {
@@ -102,11 +160,11 @@ void Executor::executeWithState(DAG &dag, vector<Transaction> &txs, State &state
     metrics.log("=== Execution Start ===");
 
     // adjacency
-    auto adj = dag.getAdjList();
+    const auto &adj = dag.getAdjList();
 
     // build lookup
-    unordered_map<string, Transaction> lookup;
-    for (auto &tx : txs) lookup[tx.getId()] = tx;
+    unordered_map<string, const Transaction*> lookup;
+    for (auto &tx : txs) lookup[tx.getId()] = &tx;
 
     // IMPORTANT: initialize indegree for ALL transactions (not only keys found in adj)
     unordered_map<string, int> indeg;
@@ -132,6 +190,9 @@ void Executor::executeWithState(DAG &dag, vector<Transaction> &txs, State &state
     }
 
     int batchNum = 1;
+    size_t totalGroups = 0;
+    long long partitionUs = 0;
+    auto wavesStart = chrono::high_resolution_clock::now();
 
     while (!batch.empty()) {
 
@@ -154,7 +215,11 @@ void Executor::executeWithState(DAG &dag, vector<Transaction> &txs, State &state
 
         long long batchTime = metrics.measureDuration([&]() {
 
-            auto groups = partitionIntoConflictFreeGroups(batch, lookup);
+            vector<vector<string>> groups;
+            partitionUs += metrics.measurePhase("partition", [&]() {
+                groups = partitionIntoConflictFreeGroups(batch, lookup, partitionStrategy);
+            });
+            totalGroups += groups.size();
             metrics.log("    Group count=" + to_string(groups.size()));
 
             int groupNum = 1;
@@ -162,6 +227,8 @@ void Executor::executeWithState(DAG &dag, vector<Transaction> &txs, State &state
                 { lock_guard<mutex> lock(coutMutex);
                   cout << "  Group " << groupNum << " (parallel size = " << group.size() << ")\n"; }
 
+                LiveStats::get().setProgress(batchNum, groupNum);
+
                 // Notify observer & trace for group start
                 if (observer.onGroupStart) observer.onGroupStart(batchNum, groupNum, group);
                 {
@@ -177,53 +244,56 @@ void Executor::executeWithState(DAG &dag, vector<Transaction> &txs, State &state
 
                 long long groupTime = metrics.measureDuration([&]() {
 
-                    vector<unordered_map<string, long long>> localDeltas;
+                    vector<TxDelta> localDeltas;
                     localDeltas.reserve(group.size());
                     mutex deltasMutex;
 
+                    auto evalOne = [&](const string &txID) {
+                        TxDelta delta = evaluateTransaction(*lookup.at(txID));
+
+                        { lock_guard<mutex> lock(deltasMutex);
+                          localDeltas.push_back(delta); }
+
+                        { lock_guard<mutex> lock(coutMutex);
+                          cout << "    Evaluated " << txID << " on thread " << this_thread::get_id() << "\n"; }
+
+                        // observer + trace for tx evaluated
+                        try {
+                            const std::string &threadIdStr = currentThreadIdString();
+                            if (observer.onTxEvaluated) observer.onTxEvaluated(txID, threadIdStr, delta);
+
+                            // built in a per-thread buffer; only the stored event is allocated
+                            thread_local std::string e;
+                            e.clear();
+                            e += "{\"type\":\"tx_eval\",\"txId\":\"";
+                            appendJsonEscaped(e, txID);
+                            e += "\",\"threadId\":\"";
+                            e += threadIdStr;
+                            e += "\",\"delta\":";
+                            appendDeltaJson(e, delta);
+                            e += "}";
+                            TraceWriter::get().pushEvent(e);
+                        } catch (...) {
+                            // swallow
+                        }
+                    };
+
+                    // the task holds two pointers; `group` outlives waitAll()
+                    uint64_t dispatchedNs = liveDispatchNs();
                     for (auto &txID : group) {
-                        pool.enqueue([&, txID]() {
-                            unordered_map<string, long long> delta;
-                            const Transaction &t = lookup.at(txID);
-                            string from = ""; string to = "";
-                            if (!t.getReadSet().empty()) from = *t.getReadSet().begin();
-                            if (!t.getWriteSet().empty()) to = *t.getWriteSet().begin();
-                            if (!from.empty() && !to.empty()) {
-                                delta[from]--;
-                                delta[to]++;
-                            }
-
-                            { lock_guard<mutex> lock(deltasMutex);
-                              localDeltas.push_back(delta); }
-
-                            { lock_guard<mutex> lock(coutMutex);
-                              cout << "    Evaluated " << txID << " on thread " << this_thread::get_id() << "\n"; }
-
-                            // observer + trace for tx evaluated
-                            try {
-                                size_t thh = std::hash<std::thread::id>{}(std::this_thread::get_id());
-                                std::string threadIdStr = std::to_string(thh);
-                                if (observer.onTxEvaluated) {
-                                    unordered_map<string,long long> copyDelta = delta;
-                                    observer.onTxEvaluated(txID, threadIdStr, copyDelta);
-                                }
-
-                                std::ostringstream e;
-                                e << "{\"type\":\"tx_eval\",\"txId\":\"" << escapeJsonString(txID) << "\",";
-                                e << "\"threadId\":\"" << threadIdStr << "\",";
-                                e << "\"delta\":" << deltaToJson(delta) << "}";
-                                TraceWriter::get().pushEvent(e.str());
-                            } catch (...) {
-                                // swallow
-                            }
-                        });
+                        pool.enqueue([&evalOne, &txID]() { evalOne(txID); });
                     }
 
                     pool.waitAll();
 
-                    unordered_map<string, long long> merged;
-                    for (auto &d : localDeltas)
-                        for (auto &p : d) merged[p.first] += p.second;
+                    // one "merge" phase per group: sum the deltas, apply the result
+                    StateDelta merged;
+                    metrics.measurePhase("merge", [&]() {
+                        for (auto &d : localDeltas)
+                            for (auto &p : d) merged[p.first] += p.second;
+                        state.applyDelta(merged);
+                    });
+                    liveApplied(dispatchedNs, group.size());
 
                     { lock_guard<mutex> lock(coutMutex);
                       cout << "    Merged group delta into global state\n"; }
@@ -235,9 +305,6 @@ void Executor::executeWithState(DAG &dag, vector<Transaction> &txs, State &state
                         TraceWriter::get().pushEvent(e.str());
                     }
 
-                    // apply merged delta
-                    state.applyDelta(merged);
-
                 });
 
                 metrics.log("        Group " + to_string(groupNum) + " time=" + to_string(groupTime) + "ms");
@@ -265,9 +332,736 @@ void Executor::executeWithState(DAG &dag, vector<Transaction> &txs, State &state
         batchNum++;
     }
 
+    long long makespanUs = chrono::duration_cast<chrono::microseconds>(
+        chrono::high_resolution_clock::now() - wavesStart).count();
+    metrics.log("waves partition=" + partitionStrategyName(partitionStrategy) +
+                " batches=" + to_string(batchNum - 1) +
+                " groups=" + to_string(totalGroups) +
+                " partitionUs=" + to_string(partitionUs) +
+                " makespanUs=" + to_string(makespanUs));
     metrics.log("=== Execution End ===");
     if (observer.onExecutionEnd) observer.onExecutionEnd();
     TraceWriter::get().pushEvent("{\"type\":\"execution_end\"}");
 
     cout << "\nExecution with metrics complete.\n";
 }
+
+// DAG re-expressed over positions in `txs`, with atomic indegrees that workers can
+// decrement without touching any shared map
+struct IndexedGraph {
+    IndexedDAG dag;
+    unique_ptr<atomic<int>[]> indeg;
+};
+
+static IndexedGraph buildIndexedGraph(const DAG &dag, const vector<Transaction> &txs) {
+    IndexedGraph g;
+    g.dag = indexDAG(dag, txs);
+    const size_t n = g.dag.size();
+    g.indeg.reset(new atomic<int>[n]);
+    for (size_t i = 0; i < n; ++i) g.indeg[i].store(0, memory_order_relaxed);
+    for (size_t t : g.dag.targets) g.indeg[t].fetch_add(1, memory_order_relaxed);
+    return g;
+}
+
+static void notifyExecutionEnd(const ExecutionObserver &observer) {
+    if (observer.onExecutionEnd) observer.onExecutionEnd();
+    TraceWriter::get().pushEvent("{\"type\":\"execution_end\"}");
+}
+
+// One level's transactions: a slice of ResolvedLevels (or of any pointer array)
+struct LevelSpan {
+    const Transaction **first;
+    size_t count;
+    size_t size() const { return count; }
+    const Transaction *operator[](size_t i) const { return first[i]; }
+    const Transaction **begin() const { return first; }
+    const Transaction **end() const { return first + count; }
+};
+
+// Topological levels resolved to transactions, flat: level k is
+// txs[starts[k] .. starts[k + 1]). A handful of arrays however large the block.
+struct ResolvedLevels {
+    vector<const Transaction*> txs;
+    vector<size_t> starts;
+    size_t levels() const { return starts.empty() ? 0 : starts.size() - 1; }
+    LevelSpan level(size_t k) { return {txs.data() + starts[k], starts[k + 1] - starts[k]}; }
+    size_t widest() const {
+        size_t w = 0;
+        for (size_t k = 0; k + 1 < starts.size(); ++k) w = max(w, starts[k + 1] - starts[k]);
+        return w;
+    }
+};
+
+static ResolvedLevels resolveLevels(const DAG &dag, const vector<Transaction> &txs) {
+    LevelOrder order = topologicalLevels(indexDAG(dag, txs));
+    ResolvedLevels levels;
+    levels.txs.reserve(order.order.size());
+    for (size_t p : order.order) levels.txs.push_back(&txs[p]);
+    levels.starts = move(order.starts);
+    return levels;
+}
+
+void Executor::execute(ExecutionMode mode, DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics) {
+    if (threadPoolSize == 0) threadPoolSize = 1;
+    LiveStats::get().setMode(executionModeName(mode), txs.size());
+
+    long long runUs = metrics.measurePhase("execute", [&]() {
+        switch (mode) {
+            case ExecutionMode::Sequential:
+                executeSequential(dag, txs, state, threadPoolSize, metrics);
+                break;
+            case ExecutionMode::ParallelBatches:
+                executeParallelBatches(dag, txs, state, threadPoolSize, metrics);
+                break;
+            case ExecutionMode::BatchThreads:
+                executeParallelBatchesWithThreads(dag, txs, state, threadPoolSize, metrics);
+                break;
+            case ExecutionMode::PriorityBatches:
+                executePriorityScheduledBatches(dag, txs, state, threadPoolSize, metrics);
+                break;
+            case ExecutionMode::ThreadPoolBatches:
+                executeWithThreadPool(dag, txs, state, threadPoolSize, metrics);
+                break;
+            case ExecutionMode::Waves:
+                executeWithState(dag, txs, state, threadPoolSize, metrics);
+                break;
+            case ExecutionMode::DependencyDriven:
+                executeDependencyDriven(dag, txs, state, threadPoolSize, metrics);
+                break;
+            case ExecutionMode::Components:
+                executeByComponents(dag, txs, state, threadPoolSize, metrics);
+                break;
+            case ExecutionMode::Coarsened:
+                executeCoarsened(dag, txs, state, threadPoolSize, metrics);
+                break;
+        }
+    });
+
+    long long txPerSec = runUs > 0 ? (long long)(txs.size() * 1000000.0 / runUs) : 0;
+    metrics.log("strategy=" + executionModeName(mode) +
+                " threads=" + to_string(mode == ExecutionMode::Sequential ? 1 : threadPoolSize) +
+                " txs=" + to_string(txs.size()) +
+                " runUs=" + to_string(runUs) +
+                " txPerSec=" + to_string(txPerSec));
+}
+
+void Executor::executeSequential(DAG &, vector<Transaction> &txs, State &state, size_t, Metrics &metrics) {
+    metrics.log("=== Sequential Execution Start ===");
+
+    // every DAG edge points forward in the block, so block order is already a
+    // topological order: no level computation needed
+    string threadIdStr = observer.onTxEvaluated ? currentThreadIdString() : "";
+    for (const Transaction &tx : txs) {
+        uint64_t dispatchedNs = liveDispatchNs();
+        TxDelta delta = evaluateTransaction(tx);
+        state.applyDelta(delta);
+        liveApplied(dispatchedNs);
+        if (observer.onTxEvaluated) observer.onTxEvaluated(tx.getId(), threadIdStr, delta);
+    }
+
+    metrics.log("=== Sequential Execution End ===");
+    notifyExecutionEnd(observer);
+}
+
+void Executor::executeParallelBatches(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics) {
+    metrics.log("=== Parallel Batches Execution Start ===");
+
+    // fork-join per level: one contiguous chunk per thread, each writing its
+    // transactions' delta slots; the level is applied after the join
+    ResolvedLevels levels = resolveLevels(dag, txs);
+    vector<TxDelta> deltas;
+    deltas.reserve(levels.widest());
+    vector<thread> threads;
+    threads.reserve(threadPoolSize);
+    for (size_t k = 0; k < levels.levels(); ++k) {
+        LevelSpan level = levels.level(k);
+        size_t workers = max<size_t>(1, min(threadPoolSize, level.size()));
+        size_t chunk = (level.size() + workers - 1) / workers;
+        deltas.resize(level.size());
+
+        auto runChunk = [&](size_t w) {
+            string threadIdStr = observer.onTxEvaluated ? currentThreadIdString() : "";
+            size_t end = min(level.size(), (w + 1) * chunk);
+            for (size_t i = w * chunk; i < end; ++i) {
+                deltas[i] = evaluateTransaction(*level[i]);
+                if (observer.onTxEvaluated) observer.onTxEvaluated(level[i]->getId(), threadIdStr, deltas[i]);
+            }
+        };
+
+        uint64_t dispatchedNs = liveDispatchNs();
+        threads.clear();
+        for (size_t w = 1; w < workers; ++w) threads.emplace_back(runChunk, w);
+        runChunk(0);
+        for (auto &t : threads) t.join();
+
+        for (size_t i = 0; i < level.size(); ++i) state.applyDelta(deltas[i]);
+        liveApplied(dispatchedNs, level.size());
+    }
+
+    metrics.log("=== Parallel Batches Execution End ===");
+    notifyExecutionEnd(observer);
+}
+
+void Executor::executeParallelBatchesWithThreads(DAG &dag, vector<Transaction> &txs, State &state, size_t, Metrics &metrics) {
+    metrics.log("=== Thread-per-Transaction Execution Start ===");
+
+    // one thread per transaction, as in commit 4; spawned in rounds so a wide
+    // level cannot exhaust the OS thread limit
+    const size_t maxThreadsPerRound = 256;
+
+    ResolvedLevels levels = resolveLevels(dag, txs);
+    vector<TxDelta> deltas;
+    deltas.reserve(levels.widest());
+    vector<thread> threads;
+    threads.reserve(maxThreadsPerRound);
+    for (size_t k = 0; k < levels.levels(); ++k) {
+        LevelSpan level = levels.level(k);
+        deltas.resize(level.size());
+        uint64_t dispatchedNs = liveDispatchNs();
+        for (size_t begin = 0; begin < level.size(); begin += maxThreadsPerRound) {
+            size_t end = min(level.size(), begin + maxThreadsPerRound);
+            threads.clear();
+            for (size_t i = begin; i < end; ++i) {
+                threads.emplace_back([&, i]() {
+                    deltas[i] = evaluateTransaction(*level[i]);
+                    if (observer.onTxEvaluated)
+                        observer.onTxEvaluated(level[i]->getId(), currentThreadIdString(), deltas[i]);
+                });
+            }
+            for (auto &t : threads) t.join();
+        }
+        for (size_t i = 0; i < level.size(); ++i) state.applyDelta(deltas[i]);
+        liveApplied(dispatchedNs, level.size());
+    }
+
+    metrics.log("=== Thread-per-Transaction Execution End ===");
+    notifyExecutionEnd(observer);
+}
+
+// One pool task per transaction of a level; each writes its own delta slot, so
+// no lock is taken until the level is merged in dispatch order.
+struct LevelJob {
+    LevelSpan level;
+    vector<TxDelta> *deltas;
+    const ExecutionObserver *observer;
+
+    static void run(void *ctx, size_t i) {
+        LevelJob &job = *static_cast<LevelJob*>(ctx);
+        TxDelta &delta = (*job.deltas)[i];
+        delta = evaluateTransaction(*job.level[i]);
+        if (job.observer->onTxEvaluated)
+            job.observer->onTxEvaluated(job.level[i]->getId(), currentThreadIdString(), delta);
+    }
+};
+
+// `deltas` is scratch reused across levels, so a run allocates its delta slots once
+static void runLevelOnPool(ThreadPool &pool, LevelSpan level, vector<TxDelta> &deltas, State &state,
+                           const ExecutionObserver &observer) {
+    deltas.resize(level.size());
+    LevelJob job{level, &deltas, &observer};
+    uint64_t dispatchedNs = liveDispatchNs();
+    for (size_t i = 0; i < level.size(); ++i) pool.enqueue(&LevelJob::run, &job, i);
+    pool.waitAll();
+    for (size_t i = 0; i < level.size(); ++i) state.applyDelta(deltas[i]);
+    liveApplied(dispatchedNs, level.size());
+}
+
+void Executor::executePriorityScheduledBatches(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics) {
+    metrics.log("=== Priority Scheduled Execution Start ===");
+
+    ResolvedLevels levels = resolveLevels(dag, txs);
+    ThreadPool pool(threadPoolSize);
+    pool.reserve(levels.widest());
+    vector<TxDelta> deltas;
+    deltas.reserve(levels.widest());
+    for (size_t k = 0; k < levels.levels(); ++k) {
+        LevelSpan level = levels.level(k);
+        // miner order (commit 5): higher fee first, earlier timestamp breaks ties
+        sort(level.begin(), level.end(), [](const Transaction *a, const Transaction *b) {
+            if (a->getFee() != b->getFee()) return a->getFee() > b->getFee();
+            return a->getTimestamp() < b->getTimestamp();
+        });
+        runLevelOnPool(pool, level, deltas, state, observer);
+    }
+
+    metrics.log("=== Priority Scheduled Execution End ===");
+    notifyExecutionEnd(observer);
+}
+
+void Executor::executeWithThreadPool(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics) {
+    metrics.log("=== Thread Pool Execution Start ===");
+
+    ResolvedLevels levels = resolveLevels(dag, txs);
+    ThreadPool pool(threadPoolSize);
+    pool.reserve(levels.widest());
+    vector<TxDelta> deltas;
+    deltas.reserve(levels.widest());
+    for (size_t k = 0; k < levels.levels(); ++k) runLevelOnPool(pool, levels.level(k), deltas, state, observer);
+
+    metrics.log("=== Thread Pool Execution End ===");
+    notifyExecutionEnd(observer);
+}
+
+// State shared by the tasks of one dependency-driven run; tasks are (run, position)
+// pairs, so releasing a successor enqueues two words and allocates nothing
+struct DependencyRun {
+    const IndexedGraph *g;
+    vector<Transaction> *txs;
+    State *state;
+    mutex *stateMutex;
+    const ExecutionObserver *observer;
+    ThreadPool *pool;
+    unique_ptr<uint64_t[]> dispatchedNs;   // written before the task is enqueued
+
+    static void run(void *ctx, size_t i) {
+        DependencyRun &r = *static_cast<DependencyRun*>(ctx);
+        TxDelta delta = evaluateTransaction((*r.txs)[i]);
+        {
+            lock_guard<mutex> lock(*r.stateMutex);
+            r.state->applyDelta(delta);
+        }
+        liveApplied(r.dispatchedNs[i]);
+        if (r.observer->onTxEvaluated)
+            r.observer->onTxEvaluated((*r.txs)[i].getId(), currentThreadIdString(), delta);
+
+        // the last predecessor to finish releases the successor
+        for (size_t s : r.g->dag.successors(i)) {
+            if (r.g->indeg[s].fetch_sub(1, memory_order_acq_rel) == 1) {
+                r.dispatchedNs[s] = liveDispatchNs();
+                r.pool->enqueue(&DependencyRun::run, ctx, s);
+            }
+        }
+    }
+};
+
+void Executor::executeDependencyDriven(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics) {
+    metrics.log("=== Dependency-driven Execution Start ===");
+
+    const size_t n = txs.size();
+    IndexedGraph g = buildIndexedGraph(dag, txs);
+
+    ThreadPool pool(threadPoolSize);
+    pool.reserve(n);
+    mutex stateMutex;
+    DependencyRun run{&g, &txs, &state, &stateMutex, &observer, &pool,
+                      unique_ptr<uint64_t[]>(new uint64_t[n]())};
+
+    // collect the roots before submitting any: once tasks run, successors reach
+    // indegree 0 concurrently and this scan would submit them a second time
+    vector<size_t> roots;
+    for (size_t i = 0; i < n; ++i) {
+        if (g.indeg[i].load(memory_order_relaxed) == 0) roots.push_back(i);
+    }
+    for (size_t i : roots) {
+        run.dispatchedNs[i] = liveDispatchNs();
+        pool.enqueue(&DependencyRun::run, &run, i);
+    }
+    pool.waitAll();
+
+    metrics.log("=== Dependency-driven Execution End ===");
+    notifyExecutionEnd(observer);
+}
+
+void Executor::executeByComponents(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics) {
+    metrics.log("=== Component Execution Start ===");
+
+    ComponentSet set;
+    long long findUs = metrics.measureDurationUs([&]() {
+        set = findConnectedComponents(indexDAG(dag, txs), threadPoolSize);
+    });
+
+    // a few units per worker keeps the pool balanced without one task per tiny component
+    size_t target = max<size_t>(1, txs.size() / max<size_t>(1, threadPoolSize * 4));
+    auto units = packComponents(set, target);
+
+    metrics.log("    Components=" + to_string(set.count()) +
+                " largest=" + to_string(set.largest()) +
+                " maxDepth=" + to_string(set.maxDepth()) +
+                " units=" + to_string(units.size()) +
+                " findUs=" + to_string(findUs));
+
+    ThreadPool pool(threadPoolSize);
+    pool.reserve(units.size());
+    mutex stateMutex;
+
+    // each unit runs its components in topological order with no barrier and
+    // no shared bookkeeping; only the unit's combined delta touches the state
+    for (auto &unit : units) {
+        uint64_t dispatchedNs = liveDispatchNs();
+        pool.enqueue([&, dispatchedNs]() {
+            string threadIdStr = observer.onTxEvaluated ? currentThreadIdString() : "";
+            size_t unitTxs = 0;
+            for (size_t c : unit) unitTxs += set.size(c);
+            vector<TxDelta> unitDeltas;
+            unitDeltas.reserve(unitTxs);
+            for (size_t c : unit) {
+                for (size_t p : set.component(c)) {
+                    unitDeltas.push_back(evaluateTransaction(txs[p]));
+                    if (observer.onTxEvaluated) observer.onTxEvaluated(txs[p].getId(), threadIdStr, unitDeltas.back());
+                }
+            }
+            {
+                lock_guard<mutex> lock(stateMutex);
+                for (auto &d : unitDeltas) state.applyDelta(d);
+            }
+            liveApplied(dispatchedNs, unitTxs);
+        });
+    }
+    pool.waitAll();
+
+    metrics.log("=== Component Execution End ===");
+    notifyExecutionEnd(observer);
+}
+
+void Executor::executeWithScheduleCache(vector<Transaction> &txs, State &state, ScheduleCache &cache,
+                                        size_t threadPoolSize, Metrics &metrics) {
+    metrics.log("=== Cached Schedule Execution Start ===");
+
+    BlockShape shape;
+    long long shapeUs = metrics.measureDurationUs([&]() {
+        shape = computeBlockShape(txs, partitionStrategy);
+    });
+
+    Schedule schedule;
+    long long storedBuildUs = 0;
+    bool hit = false;
+    long long lookupUs = metrics.measureDurationUs([&]() {
+        hit = cache.lookup(shape, txs, schedule, storedBuildUs);
+    });
+
+    long long buildUs = 0;
+    if (!hit) {
+        buildUs = metrics.measureDurationUs([&]() {
+            DAG dag;
+            dag.buildFromTransactions(txs);
+            unordered_map<string, uint32_t> position;
+            unordered_map<string, const Transaction*> lookup;
+            for (size_t i = 0; i < txs.size(); ++i) {
+                position[txs[i].getId()] = (uint32_t)i;
+                lookup[txs[i].getId()] = &txs[i];
+            }
+            for (auto &level : dag.getLevels()) {
+                schedule.emplace_back();
+                for (auto &group : partitionIntoConflictFreeGroups(level, lookup, partitionStrategy)) {
+                    schedule.back().emplace_back();
+                    for (auto &id : group) schedule.back().back().push_back(position.at(id));
+                }
+            }
+        });
+        cache.insert(shape, schedule, buildUs);
+    }
+
+    size_t groups = 0;
+    ThreadPool pool(threadPoolSize);
+    long long runUs = metrics.measureDurationUs([&]() {
+        vector<const Transaction*> ptrs;
+        vector<TxDelta> deltas;
+        for (auto &batch : schedule) {
+            for (auto &group : batch) {
+                ptrs.clear();
+                for (uint32_t p : group) ptrs.push_back(&txs[p]);
+                runLevelOnPool(pool, {ptrs.data(), ptrs.size()}, deltas, state, observer);
+                groups++;
+            }
+        }
+    });
+
+    metrics.log("schedcache hit=" + to_string(hit ? 1 : 0) +
+                " fingerprint=" + to_string(shape.fingerprint) +
+                " shapeUs=" + to_string(shapeUs) +
+                " lookupUs=" + to_string(lookupUs) +
+                " buildUs=" + to_string(hit ? storedBuildUs : buildUs) +
+                " batches=" + to_string(schedule.size()) +
+                " groups=" + to_string(groups) +
+                " runUs=" + to_string(runUs) +
+                " hits=" + to_string(cache.hits) + "/" + to_string(cache.lookups) +
+                " rejected=" + to_string(cache.rejected) +
+                " savedUs=" + to_string(cache.savedUs));
+    metrics.log("=== Cached Schedule Execution End ===");
+    notifyExecutionEnd(observer);
+}
+
+// State shared by the tasks of one coarsened run; tasks are (run, index) pairs
+struct CoarseRun {
+    const CoarsePlan *plan;
+    vector<Transaction> *txs;
+    State *state;
+    mutex *stateMutex;
+    const ExecutionObserver *observer;
+    ThreadPool *pool;
+    unique_ptr<atomic<int>[]> indeg;
+    unique_ptr<uint64_t[]> dispatchedNs;   // written before the task is enqueued
+    atomic<long long> busyNs{0};
+
+    static void run(void *ctx, size_t t) {
+        CoarseRun &r = *static_cast<CoarseRun*>(ctx);
+        auto start = chrono::steady_clock::now();
+        string threadIdStr = r.observer->onTxEvaluated ? currentThreadIdString() : "";
+        IndexRange task = r.plan->task(t);
+        // per worker and kept across tasks: after the first few tasks it never regrows
+        thread_local vector<TxDelta> taskDeltas;
+        taskDeltas.clear();
+        for (size_t i : task) {
+            taskDeltas.push_back(evaluateTransaction((*r.txs)[i]));
+            if (r.observer->onTxEvaluated) r.observer->onTxEvaluated((*r.txs)[i].getId(), threadIdStr, taskDeltas.back());
+        }
+        r.busyNs.fetch_add(chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - start).count(), memory_order_relaxed);
+        {
+            lock_guard<mutex> lock(*r.stateMutex);
+            for (auto &d : taskDeltas) r.state->applyDelta(d);
+        }
+        liveApplied(r.dispatchedNs[t], task.size());
+        for (size_t s : r.plan->succ.successors(t)) {
+            if (r.indeg[s].fetch_sub(1, memory_order_acq_rel) == 1) {
+                r.dispatchedNs[s] = liveDispatchNs();
+                r.pool->enqueue(&CoarseRun::run, ctx, s);
+            }
+        }
+    }
+};
+
+void Executor::executeCoarsened(DAG &dag, vector<Transaction> &txs, State &state, size_t threadPoolSize, Metrics &metrics) {
+    metrics.log("=== Coarsened Execution Start ===");
+
+    const size_t n = txs.size();
+    IndexedGraph g = buildIndexedGraph(dag, txs);
+
+    // first run: time a sample so the first chunk size is not a guess. The
+    // sample is far below a microsecond per tx, so it is timed in nanoseconds;
+    // it only evaluates, so nothing reaches the state or the live stats.
+    double txNs = coarsening.measuredTxNs;
+    if (txNs <= 0.0 && n > 0) {
+        size_t sample = min<size_t>(n, 256);
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < sample; ++i) evaluateTransaction(txs[i]);
+        long long sampleNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        txNs = max(1.0, sampleNs / (double)sample);
+    }
+    size_t txsPerTask = coarseTaskSize(coarsening, txNs);
+
+    CoarsePlan plan;
+    long long passUs = metrics.measureDurationUs([&]() {
+        plan = coarsenSchedule(g.dag, txsPerTask, threadPoolSize);
+    });
+
+    ThreadPool pool(threadPoolSize);
+    pool.reserve(plan.taskCount());
+    mutex stateMutex;
+    CoarseRun run{&plan, &txs, &state, &stateMutex, &observer, &pool,
+                  unique_ptr<atomic<int>[]>(new atomic<int>[plan.taskCount()]),
+                  unique_ptr<uint64_t[]>(new uint64_t[plan.taskCount()]())};
+    for (size_t t = 0; t < plan.taskCount(); ++t) run.indeg[t].store(plan.indeg[t], memory_order_relaxed);
+
+    long long runUs = metrics.measureDurationUs([&]() {
+        for (size_t t = 0; t < plan.taskCount(); ++t) {
+            if (plan.indeg[t] != 0) continue;
+            run.dispatchedNs[t] = liveDispatchNs();
+            pool.enqueue(&CoarseRun::run, &run, t);
+        }
+        pool.waitAll();
+    });
+
+    // feed the observed cost back so the next block is chunked for it
+    double observedNs = n > 0 ? (double)run.busyNs.load() / (double)n : 0.0;
+    if (observedNs > 0.0) {
+        coarsening.measuredTxNs = coarsening.measuredTxNs > 0.0
+            ? 0.7 * coarsening.measuredTxNs + 0.3 * observedNs
+            : observedNs;
+    }
+
+    metrics.log("coarsen txs=" + to_string(n) +
+                " units=" + to_string(plan.units) +
+                " chains=" + to_string(plan.chains) +
+                " chainedTxs=" + to_string(plan.chainedTxs) +
+                " tasks=" + to_string(plan.taskCount()) +
+                " packed=" + to_string(plan.packedTasks) +
+                " txsPerTask=" + to_string(txsPerTask) +
+                " txCostNs=" + to_string((long long)txNs) +
+                " observedTxNs=" + to_string((long long)observedNs) +
+                " passUs=" + to_string(passUs) +
+                " runUs=" + to_string(runUs));
+    metrics.log("=== Coarsened Execution End ===");
+    notifyExecutionEnd(observer);
+}
+
+void Executor::executeWithPrefetch(DAG &dag, vector<Transaction> &txs, State &state, SlowStateBackend &backend,
+                                   size_t threadPoolSize, size_t maxInFlight, Metrics &metrics) {
+    metrics.log("=== Prefetch Execution Start ===");
+
+    const size_t n = txs.size();
+    const bool blocking = maxInFlight <= 1;
+    IndexedGraph g = buildIndexedGraph(dag, txs);
+
+    vector<vector<string>> keysOf(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (auto &k : txs[i].getReadSet()) keysOf[i].push_back(k);
+        for (auto &k : txs[i].getWriteSet())
+            if (!txs[i].getReadSet().count(k)) keysOf[i].push_back(k);
+    }
+
+    deque<size_t> readyQueue;
+    mutex readyMutex;
+    condition_variable readyCv;   // a transaction became ready, or the block finished
+    vector<uint64_t> readyNs(n, 0);   // written under readyMutex when queued
+    for (size_t i = 0; i < n; ++i) {
+        if (g.indeg[i].load(memory_order_relaxed) != 0) continue;
+        readyNs[i] = liveDispatchNs();
+        readyQueue.push_back(i);
+    }
+
+    mutex stateMutex;
+    atomic<size_t> completed(0);
+    atomic<size_t> stalls(0);
+
+    auto run = [&](size_t i) {
+        TxDelta delta = evaluateTransaction(txs[i]);
+        {
+            lock_guard<mutex> lock(stateMutex);
+            state.applyDelta(delta);
+        }
+        liveApplied(readyNs[i]);
+        if (observer.onTxEvaluated) observer.onTxEvaluated(txs[i].getId(), currentThreadIdString(), delta);
+
+        for (size_t s : g.dag.successors(i)) {
+            int left = g.indeg[s].fetch_sub(1, memory_order_acq_rel) - 1;
+            if (left == 0) {
+                {
+                    lock_guard<mutex> lock(readyMutex);
+                    readyNs[s] = liveDispatchNs();
+                    readyQueue.push_back(s);
+                }
+                readyCv.notify_one();
+            } else if (left == 1 && !blocking) {
+                // one predecessor away from ready: start its loads now
+                for (auto &k : keysOf[s]) backend.prefetch(k);
+            }
+        }
+        if (completed.fetch_add(1, memory_order_acq_rel) + 1 == n) {
+            lock_guard<mutex> lock(readyMutex);
+            readyCv.notify_all();
+        }
+    };
+
+    // Each in-flight entry is a suspended transaction: it was started (loads
+    // issued) and resumes once every key it touches is resident.
+    auto worker = [&]() {
+        vector<size_t> inFlight;
+        const size_t window = blocking ? 1 : maxInFlight;
+
+        while (completed.load(memory_order_acquire) < n) {
+            while (inFlight.size() < window) {
+                size_t next;
+                {
+                    lock_guard<mutex> lock(readyMutex);
+                    if (readyQueue.empty()) break;
+                    next = readyQueue.front();
+                    readyQueue.pop_front();
+                }
+                if (blocking) {
+                    for (auto &k : keysOf[next]) backend.load(k);
+                    run(next);
+                    continue;
+                }
+                for (auto &k : keysOf[next]) backend.prefetch(k);
+                inFlight.push_back(next);
+            }
+
+            bool progressed = false;
+            for (size_t j = 0; j < inFlight.size();) {
+                size_t i = inFlight[j];
+                bool ready = true;
+                for (auto &k : keysOf[i]) {
+                    if (!backend.isResident(k)) { ready = false; break; }
+                }
+                if (ready) {
+                    run(i);
+                    inFlight[j] = inFlight.back();
+                    inFlight.pop_back();
+                    progressed = true;
+                } else {
+                    ++j;
+                }
+            }
+
+            if (!progressed) {
+                stalls.fetch_add(1, memory_order_relaxed);
+                if (inFlight.empty()) {
+                    // nothing to resume: sleep until another worker releases a successor
+                    unique_lock<mutex> lock(readyMutex);
+                    readyCv.wait(lock, [&]() {
+                        return !readyQueue.empty() || completed.load(memory_order_acquire) >= n;
+                    });
+                } else {
+                    backend.waitForLoads(chrono::microseconds(200));
+                }
+            }
+        }
+    };
+
+    ThreadPool pool(threadPoolSize);
+    long long runUs = metrics.measureDurationUs([&]() {
+        for (size_t w = 0; w < threadPoolSize; ++w) pool.enqueue([&worker]() { worker(); });
+        pool.waitAll();
+    });
+
+    metrics.log("prefetch inFlight=" + to_string(blocking ? 1 : maxInFlight) +
+                " threads=" + to_string(threadPoolSize) +
+                " txs=" + to_string(n) +
+                " stalls=" + to_string(stalls.load()) +
+                " runUs=" + to_string(runUs));
+    metrics.log("=== Prefetch Execution End ===");
+    notifyExecutionEnd(observer);
+
+    cout << "\nPrefetch execution: inFlight=" << (blocking ? 1 : maxInFlight)
+         << " threads=" << threadPoolSize << " in " << runUs << " us\n";
+}
+
+ExecutionMode Executor::chooseExecutionMode(const BlockStats &stats, size_t maxThreads, size_t &threads) const {
+    const AdaptivePolicy &p = adaptivePolicy;
+
+    size_t hw = max<size_t>(1, thread::hardware_concurrency());
+    size_t cap = max<size_t>(1, min(maxThreads, hw));
+    // parallelism the block can actually feed: average level width over minTxsPerThread
+    size_t useful = max<size_t>(1, (size_t)(stats.avgWidth / max<size_t>(1, p.minTxsPerThread)));
+    threads = min(cap, useful);
+
+    bool almostSerial = stats.txCount <= p.sequentialMaxTxs
+        || stats.maxWidth <= 1
+        || (double)stats.longestPath >= p.serialDepthRatio * (double)stats.txCount
+        || threads <= 1;
+    if (almostSerial) {
+        threads = 1;
+        return ExecutionMode::Sequential;
+    }
+
+    if (stats.componentCount >= threads &&
+        (double)stats.largestComponent <= p.componentsMaxShare * (double)stats.txCount)
+        return ExecutionMode::Components;
+
+    if (stats.longestPath <= p.wavesMaxDepth && stats.hotKeySkew <= p.wavesMaxSkew)
+        return ExecutionMode::Waves;
+
+    return ExecutionMode::DependencyDriven;
+}
+
+void Executor::executeAdaptive(DAG &dag, vector<Transaction> &txs, State &state, size_t maxThreads, Metrics &metrics) {
+    BlockStats stats;
+    long long statsUs = metrics.measureDurationUs([&]() {
+        stats = computeBlockStats(dag, txs);
+    });
+
+    size_t threads = 1;
+    ExecutionMode mode = chooseExecutionMode(stats, maxThreads, threads);
+    metrics.log("Adaptive decision: mode=" + executionModeName(mode) + " threads=" + to_string(threads));
+
+    long long runUs = metrics.measureDurationUs([&]() {
+        execute(mode, dag, txs, state, threads, metrics);
+    });
+
+    metrics.logDecision(executionModeName(mode), threads, stats.summary(), statsUs, runUs, txs.size());
+
+    cout << "\nAdaptive execution: mode=" << executionModeName(mode)
+         << " threads=" << threads << " (" << stats.summary() << ")"
+         << " in " << runUs << " us\n";
+}
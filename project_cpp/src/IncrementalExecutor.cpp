@@ -0,0 +1,230 @@
+// IncrementalExecutor.cpp
+#include "IncrementalExecutor.h"
+#include <algorithm>
+#include <mutex>
+#include <deque>
+using namespace std;
+
+unordered_set<size_t> IncrementalExecutor::conflictsOf(size_t e) const {
+    unordered_set<size_t> out;
+    const Transaction &tx = entries[e].tx;
+
+    // same rules as DAG::buildFromTransactions, answered from the key index
+    for (auto &k : tx.getReadSet()) {
+        auto w = writers.find(k);
+        if (w != writers.end()) out.insert(w->second.begin(), w->second.end());
+    }
+    for (auto &k : tx.getWriteSet()) {
+        auto w = writers.find(k);
+        if (w != writers.end()) out.insert(w->second.begin(), w->second.end());
+        auto r = readers.find(k);
+        if (r != readers.end()) out.insert(r->second.begin(), r->second.end());
+    }
+    out.erase(e);
+    return out;
+}
+
+void IncrementalExecutor::link(size_t e) {
+    Entry &en = entries[e];
+    for (auto &k : en.tx.getReadSet()) readers[k].insert(e);
+    for (auto &k : en.tx.getWriteSet()) writers[k].insert(e);
+
+    dag.addNode(en.tx.getId());
+    for (size_t o : conflictsOf(e)) {
+        if (entries[o].position < en.position) dag.addEdge(entries[o].tx.getId(), en.tx.getId());
+        else dag.addEdge(en.tx.getId(), entries[o].tx.getId());
+    }
+}
+
+void IncrementalExecutor::unlink(size_t e) {
+    Entry &en = entries[e];
+    for (size_t o : conflictsOf(e)) {
+        if (entries[o].position < en.position) {
+            dag.removeEdge(entries[o].tx.getId(), en.tx.getId());
+        } else {
+            // later transactions may have read what this one wrote
+            seeds.insert(o);
+        }
+    }
+    dag.removeNode(en.tx.getId());
+
+    for (auto &k : en.tx.getReadSet()) {
+        readers[k].erase(e);
+        if (readers[k].empty()) readers.erase(k);
+    }
+    for (auto &k : en.tx.getWriteSet()) {
+        writers[k].erase(e);
+        if (writers[k].empty()) writers.erase(k);
+    }
+}
+
+void IncrementalExecutor::noteCreatedKeys(const Transaction &tx, const State &state) {
+    for (auto &k : tx.getReadSet())
+        if (!state.getBalances().count(k)) createdKeys.insert(k);
+    for (auto &k : tx.getWriteSet())
+        if (!state.getBalances().count(k)) createdKeys.insert(k);
+}
+
+void IncrementalExecutor::executeBlock(const vector<Transaction> &block, State &state,
+                                       ExecutionMode mode, size_t threadPoolSize, Metrics &metrics) {
+    entries.clear();
+    byId.clear();
+    readers.clear();
+    writers.clear();
+    seeds.clear();
+    createdKeys.clear();
+    dag = DAG();
+    nextPosition = 0;
+
+    for (auto &tx : block) {
+        noteCreatedKeys(tx, state);
+        size_t e = entries.size();
+        entries.push_back({tx, nextPosition++, true, false, {}});
+        byId[tx.getId()] = e;
+        link(e);
+    }
+
+    Executor executor;
+    mutex capture;
+    executor.observer.onTxEvaluated = [&](const string &txId, const string &, const TxDelta &delta) {
+        lock_guard<mutex> lock(capture);
+        Entry &en = entries[byId.at(txId)];
+        en.delta = delta;
+        en.hasDelta = true;
+    };
+
+    vector<Transaction> txs = block;
+    executor.execute(mode, dag, txs, state, threadPoolSize, metrics);
+}
+
+bool IncrementalExecutor::addTransaction(const Transaction &tx) {
+    if (byId.count(tx.getId())) return false;   // use replaceTransaction to amend
+    size_t e = entries.size();
+    entries.push_back({tx, nextPosition++, true, false, {}});
+    byId[tx.getId()] = e;
+    link(e);
+    seeds.insert(e);
+    return true;
+}
+
+bool IncrementalExecutor::removeTransaction(const string &txId) {
+    auto it = byId.find(txId);
+    if (it == byId.end()) return false;
+    size_t e = it->second;
+    unlink(e);
+    entries[e].alive = false;
+    byId.erase(it);
+    seeds.insert(e);   // its stale delta still has to be reverted
+    return true;
+}
+
+bool IncrementalExecutor::replaceTransaction(const Transaction &tx) {
+    auto it = byId.find(tx.getId());
+    if (it == byId.end()) return false;
+    size_t e = it->second;
+    unlink(e);
+    entries[e].tx = tx;
+    link(e);
+    seeds.insert(e);
+    return true;
+}
+
+bool IncrementalExecutor::touchedByLiveDelta(const string &key) const {
+    for (auto *index : {&readers, &writers}) {
+        auto it = index->find(key);
+        if (it == index->end()) continue;
+        for (size_t e : it->second)
+            if (entries[e].hasDelta && entries[e].delta.count(key)) return true;
+    }
+    return false;
+}
+
+size_t IncrementalExecutor::reexecute(State &state, Metrics &metrics) {
+    size_t seedCount = seeds.size();
+    vector<size_t> dirty;
+
+    long long us = metrics.measureDurationUs([&]() {
+        // downstream closure over the current DAG
+        unordered_set<size_t> seen;
+        deque<size_t> frontier;
+        for (size_t e : seeds) {
+            if (seen.insert(e).second) frontier.push_back(e);
+        }
+        const auto &adj = dag.getAdjList();
+        while (!frontier.empty()) {
+            size_t e = frontier.front();
+            frontier.pop_front();
+            dirty.push_back(e);
+            if (!entries[e].alive) continue;
+            auto a = adj.find(entries[e].tx.getId());
+            if (a == adj.end()) continue;
+            for (auto &to : a->second) {
+                size_t s = byId.at(to);
+                if (seen.insert(s).second) frontier.push_back(s);
+            }
+        }
+        seeds.clear();
+
+        // keys the amended transactions bring in, before any revert
+        for (size_t e : dirty)
+            if (entries[e].alive) noteCreatedKeys(entries[e].tx, state);
+
+        // revert everything stale before applying anything new
+        unordered_set<string> reverted;
+        for (size_t e : dirty) {
+            Entry &en = entries[e];
+            if (!en.hasDelta) continue;
+            TxDelta inverse;
+            for (auto &p : en.delta) {
+                inverse[p.first] = -p.second;
+                if (createdKeys.count(p.first)) reverted.insert(p.first);
+            }
+            state.applyDelta(inverse);
+            en.hasDelta = false;
+            en.delta.clear();
+        }
+
+        // block order is a topological order of the dirty subgraph
+        sort(dirty.begin(), dirty.end(), [&](size_t a, size_t b) {
+            return entries[a].position < entries[b].position;
+        });
+        for (size_t e : dirty) {
+            Entry &en = entries[e];
+            if (!en.alive) continue;
+            en.delta = evaluateTransaction(en.tx);
+            en.hasDelta = true;
+            state.applyDelta(en.delta);
+        }
+
+        // a from-scratch run only creates a key some live delta touches
+        for (auto &k : reverted) {
+            if (state.getBalance(k) != 0 || touchedByLiveDelta(k)) continue;
+            state.eraseBalance(k);
+            createdKeys.erase(k);
+        }
+    });
+
+    size_t ran = 0;
+    for (size_t e : dirty) if (entries[e].alive) ran++;
+
+    metrics.log("incremental seeds=" + to_string(seedCount) +
+                " dirty=" + to_string(dirty.size()) +
+                " reexecuted=" + to_string(ran) +
+                " blockTxs=" + to_string(byId.size()) +
+                " us=" + to_string(us));
+    return ran;
+}
+
+vector<Transaction> IncrementalExecutor::currentBlock() const {
+    vector<size_t> order;
+    for (size_t e = 0; e < entries.size(); ++e)
+        if (entries[e].alive) order.push_back(e);
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return entries[a].position < entries[b].position;
+    });
+
+    vector<Transaction> block;
+    block.reserve(order.size());
+    for (size_t e : order) block.push_back(entries[e].tx);
+    return block;
+}
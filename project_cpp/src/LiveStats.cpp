@@ -0,0 +1,194 @@
+// LiveStats.cpp
+#include "LiveStats.h"
+#include <chrono>
+#include <cstring>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define DIPETRANS_HAVE_SHM 1
+#endif
+
+using namespace std;
+
+static uint64_t steadyNowNs() {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool livestats::readSnapshot(const Segment *seg, Snapshot &out) {
+    for (int attempt = 0; attempt < 1000; ++attempt) {
+        uint64_t before = seg->seq.load(memory_order_acquire);
+        if (before & 1) {
+            this_thread::yield();
+            continue;
+        }
+        memcpy(&out, &seg->snapshot, sizeof(Snapshot));
+        atomic_thread_fence(memory_order_acquire);
+        if (seg->seq.load(memory_order_relaxed) == before) return true;
+    }
+    return false;
+}
+
+LiveStats& LiveStats::get() {
+    static LiveStats inst;
+    return inst;
+}
+
+LiveStats::~LiveStats() {
+    close();
+}
+
+bool LiveStats::open(const string &name, unsigned intervalMs) {
+#ifndef DIPETRANS_HAVE_SHM
+    (void)name; (void)intervalMs;
+    return false;
+#else
+    if (isOpen()) return true;
+
+    // never zero a segment another run (or a reader) is still using
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, sizeof(livestats::Segment)) != 0) {
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void *p = mmap(nullptr, sizeof(livestats::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    memset(p, 0, sizeof(livestats::Segment));
+    livestats::Segment *s = new (p) livestats::Segment();
+    s->workerSlots = (uint32_t)livestats::kWorkerSlots;
+    s->latencyBuckets = (uint32_t)livestats::kLatencyBuckets;
+    s->pid = (uint64_t)getpid();
+    s->seq.store(0, memory_order_relaxed);
+    // readers check magic last, so they never see a half-initialised segment
+    s->version = livestats::kVersion;
+    atomic_thread_fence(memory_order_release);
+    s->magic = livestats::kMagic;
+
+    segName = name;
+    interval = intervalMs == 0 ? 100 : intervalMs;
+    lastNs = steadyNowNs();
+    lastCompleted = 0;
+    seg.store(s);
+
+    stopSampler.store(false);
+    sampler = thread([this]() {
+        while (!stopSampler.load(memory_order_relaxed)) {
+            publish();
+            this_thread::sleep_for(chrono::milliseconds(interval));
+        }
+        publish();
+    });
+    return true;
+#endif
+}
+
+void LiveStats::close() {
+#ifdef DIPETRANS_HAVE_SHM
+    if (!isOpen()) return;
+    stopSampler.store(true);
+    if (sampler.joinable()) sampler.join();
+    livestats::Segment *s = seg.exchange(nullptr);
+    munmap(s, sizeof(livestats::Segment));
+    shm_unlink(segName.c_str());
+#endif
+}
+
+void LiveStats::txCompleted(uint64_t latencyNs, uint64_t count) {
+    livestats::Segment *s = seg.load(memory_order_relaxed);
+    if (!s) return;
+
+    static atomic<size_t> nextSlot(0);
+    thread_local size_t slot = nextSlot.fetch_add(1, memory_order_relaxed) % livestats::kWorkerSlots;
+
+    size_t bucket = 0;
+    while (bucket + 1 < livestats::kLatencyBuckets && (latencyNs >> (bucket + 1)) != 0) ++bucket;
+
+    livestats::WorkerSlot &w = s->workers[slot];
+    w.txCompleted.fetch_add(count, memory_order_relaxed);
+    w.latency[bucket].fetch_add(count, memory_order_relaxed);
+}
+
+void LiveStats::setMode(const string &m, uint64_t txTotal) {
+    if (!isOpen()) return;
+    {
+        lock_guard<mutex> lock(modeMutex);
+        mode = m;
+    }
+    total.store(txTotal, memory_order_relaxed);
+    batch.store(0, memory_order_relaxed);
+    group.store(0, memory_order_relaxed);
+}
+
+void LiveStats::setProgress(uint64_t b, uint64_t g) {
+    if (!isOpen()) return;
+    batch.store(b, memory_order_relaxed);
+    group.store(g, memory_order_relaxed);
+}
+
+int LiveStats::addGaugeSource(const function<uint64_t()> &readyDepth, const function<uint64_t()> &active) {
+    if (!isOpen()) return -1;
+    lock_guard<mutex> lock(sourcesMutex);
+    int id = nextSourceId++;
+    sources.push_back({id, readyDepth, active});
+    return id;
+}
+
+void LiveStats::removeGaugeSource(int id) {
+    if (id < 0) return;
+    lock_guard<mutex> lock(sourcesMutex);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (sources[i].id == id) {
+            sources.erase(sources.begin() + i);
+            return;
+        }
+    }
+}
+
+// Sampler thread only: the single seqlock writer
+void LiveStats::publish() {
+    livestats::Segment *s = seg.load(memory_order_relaxed);
+    if (!s) return;
+
+    livestats::Snapshot snap;
+    memset(&snap, 0, sizeof(snap));
+
+    for (auto &w : s->workers) snap.txCompleted += w.txCompleted.load(memory_order_relaxed);
+    {
+        lock_guard<mutex> lock(sourcesMutex);
+        for (auto &src : sources) {
+            snap.readyQueueDepth += src.readyDepth();
+            snap.activeWorkers += src.active();
+        }
+    }
+    {
+        lock_guard<mutex> lock(modeMutex);
+        strncpy(snap.mode, mode.c_str(), sizeof(snap.mode) - 1);
+    }
+    snap.txTotal = total.load(memory_order_relaxed);
+    snap.currentBatch = batch.load(memory_order_relaxed);
+    snap.currentGroup = group.load(memory_order_relaxed);
+
+    uint64_t now = steadyNowNs();
+    snap.updatedNs = now;
+    uint64_t dt = now - lastNs;
+    uint64_t dtx = snap.txCompleted >= lastCompleted ? snap.txCompleted - lastCompleted : 0;
+    snap.txPerSec = dt > 0 ? (uint64_t)(dtx * 1e9 / (double)dt) : 0;
+    lastNs = now;
+    lastCompleted = snap.txCompleted;
+
+    uint64_t seq = s->seq.load(memory_order_relaxed);
+    s->seq.store(seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&s->snapshot, &snap, sizeof(snap));
+    s->seq.store(seq + 2, memory_order_release);
+}
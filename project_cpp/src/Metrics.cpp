@@ -1,4 +1,7 @@
 #include "Metrics.h"
+#include "PerfCounters.h"
+#include <map>
+#include <memory>
 using namespace std;
 
 Metrics::Metrics() {
@@ -35,8 +38,41 @@ long long Metrics::measureDuration(function<void()> func) {
     return chrono::duration_cast<chrono::milliseconds>(end - start).count();
 }
 
+long long Metrics::measureDurationUs(function<void()> func) {
+    auto start = chrono::high_resolution_clock::now();
+    func();
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration_cast<chrono::microseconds>(end - start).count();
+}
+
+long long Metrics::measurePhase(const string &phase, function<void()> func) {
+    PerfProfiler &profiler = PerfProfiler::get();
+    if (!profiler.enabled()) return measureDurationUs(func);
+
+    // perf fds count the thread that opened them, so each thread keeps one
+    // counter set per phase (phases nest) and re-arms it on every call
+    thread_local map<string, unique_ptr<PerfCounters>> perThread;
+    unique_ptr<PerfCounters> &counters = perThread[phase];
+    if (!counters) counters.reset(new PerfCounters(true));
+    counters->start();
+    long long us = measureDurationUs(func);
+    profiler.recordPhase(phase, us, counters->stop());
+    return us;
+}
+
 void Metrics::log(const string &msg) {
     if (logFile.is_open()) {
         logFile << msg << endl;
     }
 }
+
+void Metrics::logDecision(const string &mode, size_t threads, const string &stats,
+                          long long statsUs, long long runUs, size_t txCount) {
+    long long txPerSec = runUs > 0 ? (long long)(txCount * 1000000.0 / runUs) : 0;
+    log("adaptive mode=" + mode +
+        " threads=" + to_string(threads) +
+        " " + stats +
+        " statsUs=" + to_string(statsUs) +
+        " runUs=" + to_string(runUs) +
+        " txPerSec=" + to_string(txPerSec));
+}
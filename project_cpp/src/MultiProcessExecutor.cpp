@@ -0,0 +1,622 @@
+// MultiProcessExecutor.cpp
+#include "MultiProcessExecutor.h"
+#include "ThreadPool.h"
+#include "Executor.h"
+
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+#include <new>
+#include <deque>
+#include <unordered_map>
+#include <iostream>
+#include <iomanip>
+#include <random>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#define DIPETRANS_HAVE_SHM 1
+#endif
+
+using namespace std;
+
+#ifdef DIPETRANS_HAVE_SHM
+
+namespace {
+
+// atomics are shared between processes, so they must not hide a lock
+static_assert(atomic<uint64_t>::is_always_lock_free, "64-bit atomics must be lock-free");
+static_assert(atomic<int64_t>::is_always_lock_free, "64-bit atomics must be lock-free");
+
+const uint64_t kPingTask = ~uint64_t(0);
+const size_t kMaxWorkers = 256;
+// Tasks a worker may own at once. Its queues are sized to this, not to the
+// block; ready tasks beyond it wait in the coordinator's backlog.
+const size_t kMaxOutstanding = 1024;
+const size_t kNoOwner = ~size_t(0);
+
+// Bounded MPMC queue (Vyukov), constructed in place inside the segment.
+// The cell array follows the header directly.
+struct ShmQueue {
+    struct Cell {
+        atomic<uint64_t> seq;
+        uint64_t value;
+    };
+
+    uint64_t mask;
+    alignas(64) atomic<uint64_t> enqueuePos;
+    alignas(64) atomic<uint64_t> dequeuePos;
+
+    static size_t bytesFor(size_t capacity) { return sizeof(ShmQueue) + capacity * sizeof(Cell); }
+
+    Cell *cells() { return reinterpret_cast<Cell*>(this + 1); }
+
+    void init(size_t capacity) {
+        mask = capacity - 1;
+        new (&enqueuePos) atomic<uint64_t>(0);
+        new (&dequeuePos) atomic<uint64_t>(0);
+        for (size_t i = 0; i < capacity; ++i) new (&cells()[i].seq) atomic<uint64_t>(i);
+    }
+
+    bool push(uint64_t v) {
+        uint64_t pos = enqueuePos.load(memory_order_relaxed);
+        while (true) {
+            Cell &c = cells()[pos & mask];
+            uint64_t seq = c.seq.load(memory_order_acquire);
+            int64_t dif = (int64_t)seq - (int64_t)pos;
+            if (dif == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    c.value = v;
+                    c.seq.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;  // full
+            } else {
+                pos = enqueuePos.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(uint64_t &v) {
+        uint64_t pos = dequeuePos.load(memory_order_relaxed);
+        while (true) {
+            Cell &c = cells()[pos & mask];
+            uint64_t seq = c.seq.load(memory_order_acquire);
+            int64_t dif = (int64_t)seq - (int64_t)(pos + 1);
+            if (dif == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    v = c.value;
+                    c.seq.store(pos + mask + 1, memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;  // empty
+            } else {
+                pos = dequeuePos.load(memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// transfer encoded by key index: same semantics as evaluateTransaction in Executor.cpp
+struct ShmTx {
+    int32_t fromKey;  // -1 = no-op
+    int32_t toKey;
+};
+
+struct ShmResult {
+    int32_t key[2];
+    int64_t delta[2];
+};
+
+struct WorkerSlot {
+    atomic<uint64_t> tasksDone;
+};
+
+// Every worker has its own work queue and its own done queue, so each queue
+// has a single producer and a single consumer. A worker killed inside a push
+// or pop can leave at most that one cell unpublished, and only in its own
+// queues, which the coordinator drains and reinitialises when it reaps the
+// worker; no other worker's results ever wait behind it. The balances of every touched key live in the segment too; the coordinator
+// is their only writer, so a delta is committed exactly once even when the
+// worker that computed it dies and the task runs again.
+struct ShmHeader {
+    atomic<uint32_t> shutdown;
+    uint32_t txCount;
+    uint32_t workerQueues;
+    uint32_t keyCount;
+    size_t queueCapacity;
+    size_t workOffset, doneOffset, queueStride, txOffset, resultOffset, slotOffset, balanceOffset;
+};
+
+// One anonymous-after-creation POSIX shared memory segment. The name is
+// unlinked right after mapping; forked workers inherit the mapping.
+class SharedSegment {
+private:
+    char *base = nullptr;
+    size_t size = 0;
+
+public:
+    bool create(size_t bytes) {
+        static atomic<unsigned> counter(0);
+        string name = "/dipetrans-" + to_string(getpid()) + "-" + to_string(counter++);
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) return false;
+        shm_unlink(name.c_str());
+        if (ftruncate(fd, (off_t)bytes) != 0) {
+            close(fd);
+            return false;
+        }
+        void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+        base = static_cast<char*>(p);
+        size = bytes;
+        return true;
+    }
+
+    ~SharedSegment() {
+        if (base) munmap(base, size);
+    }
+
+    char *data() const { return base; }
+};
+
+static size_t alignUp(size_t v) { return (v + 63) & ~size_t(63); }
+
+static size_t nextPow2(size_t v) {
+    size_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+// Lays out header, per-worker work and done queues, transactions, results,
+// worker slots and balances
+static ShmHeader *layoutSegment(SharedSegment &seg, size_t txCount, size_t keyCount, size_t workerQueues,
+                                size_t queueCapacity) {
+    size_t stride = alignUp(ShmQueue::bytesFor(queueCapacity));
+    size_t off = alignUp(sizeof(ShmHeader));
+    size_t workOffset = off;    off += workerQueues * stride;
+    size_t doneOffset = off;    off += workerQueues * stride;
+    size_t txOffset = off;      off = alignUp(off + txCount * sizeof(ShmTx));
+    size_t resultOffset = off;  off = alignUp(off + txCount * sizeof(ShmResult));
+    size_t slotOffset = off;    off = alignUp(off + workerQueues * sizeof(WorkerSlot));
+    size_t balanceOffset = off; off = alignUp(off + keyCount * sizeof(int64_t));
+
+    if (!seg.create(off)) return nullptr;
+
+    char *base = seg.data();
+    ShmHeader *hdr = new (base) ShmHeader();
+    hdr->shutdown.store(0, memory_order_relaxed);
+    hdr->txCount = (uint32_t)txCount;
+    hdr->workerQueues = (uint32_t)workerQueues;
+    hdr->keyCount = (uint32_t)keyCount;
+    hdr->queueCapacity = queueCapacity;
+    hdr->workOffset = workOffset;
+    hdr->doneOffset = doneOffset;
+    hdr->queueStride = stride;
+    hdr->txOffset = txOffset;
+    hdr->resultOffset = resultOffset;
+    hdr->slotOffset = slotOffset;
+    hdr->balanceOffset = balanceOffset;
+
+    for (size_t w = 0; w < workerQueues; ++w) {
+        reinterpret_cast<ShmQueue*>(base + workOffset + w * stride)->init(queueCapacity);
+        reinterpret_cast<ShmQueue*>(base + doneOffset + w * stride)->init(queueCapacity);
+    }
+    auto *slots = reinterpret_cast<WorkerSlot*>(base + slotOffset);
+    for (size_t w = 0; w < workerQueues; ++w) new (&slots[w].tasksDone) atomic<uint64_t>(0);
+    return hdr;
+}
+
+template <typename T>
+static T *at(ShmHeader *hdr, size_t offset) {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(hdr) + offset);
+}
+
+static ShmQueue *workQueue(ShmHeader *hdr, size_t worker) {
+    return at<ShmQueue>(hdr, hdr->workOffset + worker * hdr->queueStride);
+}
+
+static ShmQueue *doneQueue(ShmHeader *hdr, size_t worker) {
+    return at<ShmQueue>(hdr, hdr->doneOffset + worker * hdr->queueStride);
+}
+
+// spin, then yield, then sleep: cheap when busy, quiet when idle
+static void backoff(unsigned &idle) {
+    if (idle < 64) {
+        // busy spin
+    } else if (idle < 256) {
+        sched_yield();
+    } else {
+        this_thread::sleep_for(chrono::microseconds(50));
+    }
+    ++idle;
+}
+
+// Queues are sized so a push can only fail transiently (the consumer is
+// behind); never drop the value
+static void pushWithBackoff(ShmQueue *q, uint64_t v) {
+    unsigned full = 0;
+    while (!q->push(v)) backoff(full);
+}
+
+static void workerMain(ShmHeader *hdr, size_t slot, size_t crashAfterTasks) {
+    ShmQueue *work = workQueue(hdr, slot);
+    ShmQueue *done = doneQueue(hdr, slot);
+    ShmTx *txs = at<ShmTx>(hdr, hdr->txOffset);
+    ShmResult *results = at<ShmResult>(hdr, hdr->resultOffset);
+    WorkerSlot &me = at<WorkerSlot>(hdr, hdr->slotOffset)[slot];
+
+    size_t handled = 0;
+    unsigned idle = 0;
+    while (!hdr->shutdown.load(memory_order_acquire)) {
+        uint64_t task;
+        if (!work->pop(task)) {
+            backoff(idle);
+            continue;
+        }
+        idle = 0;
+
+        if (crashAfterTasks && ++handled >= crashAfterTasks) _exit(3);  // simulated crash mid-task
+
+        if (task != kPingTask) {
+            const ShmTx &t = txs[task];
+            ShmResult &r = results[task];
+            r.key[0] = t.fromKey;
+            r.key[1] = t.toKey;
+            r.delta[0] = t.fromKey >= 0 && t.toKey >= 0 ? -1 : 0;
+            r.delta[1] = t.fromKey >= 0 && t.toKey >= 0 ? 1 : 0;
+        }
+
+        pushWithBackoff(done, task);
+        me.tasksDone.fetch_add(1, memory_order_relaxed);
+    }
+    _exit(0);
+}
+
+// < 0 if fork failed
+static pid_t spawnWorker(ShmHeader *hdr, size_t slot, size_t crashAfterTasks) {
+    pid_t pid = fork();
+    if (pid == 0) workerMain(hdr, slot, crashAfterTasks);
+    return pid;
+}
+
+static void stopWorkers(ShmHeader *hdr, vector<pid_t> &pids) {
+    hdr->shutdown.store(1, memory_order_release);
+    for (pid_t pid : pids) {
+        if (pid > 0) waitpid(pid, nullptr, 0);
+    }
+}
+
+} // namespace
+
+#endif // DIPETRANS_HAVE_SHM
+
+MultiProcessExecutor::MultiProcessExecutor(size_t workerProcesses)
+    : workers(workerProcesses == 0 ? 1 : workerProcesses) {}
+
+bool MultiProcessExecutor::execute(DAG &dag, vector<Transaction> &txs, State &state, Metrics &metrics) {
+#ifndef DIPETRANS_HAVE_SHM
+    (void)dag; (void)txs; (void)state;
+    metrics.log("multiprocess unavailable: no POSIX shared memory on this platform");
+    return false;
+#else
+    metrics.log("=== Multi-process Execution Start ===");
+    size_t procs = min(workers, kMaxWorkers);
+
+    // intern keys, so transactions are plain indices in the segment
+    unordered_map<string, int32_t> keyId;
+    vector<string> keyNames;
+    auto intern = [&](const string &k) {
+        auto it = keyId.find(k);
+        if (it != keyId.end()) return it->second;
+        keyId[k] = (int32_t)keyNames.size();
+        keyNames.push_back(k);
+        return (int32_t)keyNames.size() - 1;
+    };
+
+    const size_t n = txs.size();
+    vector<ShmTx> encoded(n);
+    unordered_map<string, size_t> index;
+    for (size_t i = 0; i < n; ++i) {
+        index[txs[i].getId()] = i;
+        for (auto &k : txs[i].getReadSet()) intern(k);
+        for (auto &k : txs[i].getWriteSet()) intern(k);
+        const auto &r = txs[i].getReadSet();
+        const auto &w = txs[i].getWriteSet();
+        encoded[i].fromKey = r.empty() ? -1 : keyId[*r.begin()];
+        encoded[i].toKey = w.empty() ? -1 : keyId[*w.begin()];
+    }
+
+    // the coordinator alone owns the graph: plain ints, no atomics needed
+    vector<vector<size_t>> succ(n);
+    vector<int> indeg(n, 0);
+    for (const auto &p : dag.getAdjList()) {
+        auto from = index.find(p.first);
+        if (from == index.end()) continue;
+        for (const auto &to : p.second) {
+            auto t = index.find(to);
+            if (t == index.end()) continue;
+            succ[from->second].push_back(t->second);
+            indeg[t->second]++;
+        }
+    }
+
+    // A worker owns at most kMaxOutstanding tasks, and each of them sits in
+    // at most one of its two queues, so neither queue can fill
+    size_t queueCapacity = nextPow2(kMaxOutstanding);
+    SharedSegment seg;
+    ShmHeader *hdr = layoutSegment(seg, n, keyNames.size(), procs, queueCapacity);
+    if (!hdr) {
+        metrics.log("multiprocess unavailable: shm_open/mmap failed");
+        return false;
+    }
+
+    ShmResult *results = at<ShmResult>(hdr, hdr->resultOffset);
+    copy(encoded.begin(), encoded.end(), at<ShmTx>(hdr, hdr->txOffset));
+
+    // touched balances are staged in the segment and written back at the end
+    int64_t *balances = at<int64_t>(hdr, hdr->balanceOffset);
+    for (size_t k = 0; k < keyNames.size(); ++k) balances[k] = state.getBalance(keyNames[k]);
+
+    cout.flush();  // do not duplicate buffered output into the children
+    vector<pid_t> pids;
+    for (size_t w = 0; w < procs; ++w) {
+        pid_t pid = spawnWorker(hdr, w, crashAfterTasks);
+        if (pid < 0) break;
+        pids.push_back(pid);
+    }
+    if (pids.empty()) {
+        metrics.log("multiprocess unavailable: fork failed");
+        return false;
+    }
+    if (pids.size() < procs) {
+        metrics.log("    fork failed after " + to_string(pids.size()) + " of " + to_string(procs) +
+                    " worker(s), running with those");
+        procs = pids.size();
+    }
+
+    // each dispatched task is owned by exactly one worker's queue until it
+    // completes; ready tasks no live worker has room for wait in `backlog`
+    vector<char> finished(n, 0), alive(procs, 1);
+    vector<size_t> owner(n, kNoOwner), outstanding(procs, 0);
+    deque<size_t> backlog;
+    size_t liveWorkers = procs;
+    auto dispatch = [&](size_t t) {
+        if (finished[t]) return;   // never hand out a task twice
+        size_t w = kNoOwner;
+        for (size_t i = 0; i < procs; ++i)
+            if (alive[i] && outstanding[i] < kMaxOutstanding && (w == kNoOwner || outstanding[i] < outstanding[w])) w = i;
+        if (w == kNoOwner) {
+            backlog.push_back(t);
+            return;
+        }
+        owner[t] = w;
+        outstanding[w]++;
+        pushWithBackoff(workQueue(hdr, w), t);
+    };
+    auto drainBacklog = [&]() {
+        while (!backlog.empty()) {
+            size_t before = backlog.size();
+            size_t t = backlog.front();
+            backlog.pop_front();
+            dispatch(t);
+            if (backlog.size() == before) break;   // went straight back: every worker is full
+        }
+    };
+
+    for (size_t i = 0; i < n; ++i)
+        if (indeg[i] == 0) dispatch(i);
+
+    size_t completed = 0, restarts = 0, redispatched = 0, kills = 0;
+    unsigned idle = 0;
+    bool failed = false;
+
+    // test hook: SIGKILL lands wherever the victim happens to be
+    mt19937 killRng(12345);
+    vector<char> signalled(procs, 0);
+    auto nextKill = chrono::steady_clock::now() + chrono::microseconds(killEveryUs);
+
+    auto complete = [&](size_t t) {
+        if (t >= n || finished[t]) return;   // stale entry; never counted twice
+        finished[t] = 1;
+        completed++;
+        if (owner[t] != kNoOwner) outstanding[owner[t]]--;
+
+        const ShmResult &r = results[t];
+        for (int j = 0; j < 2; ++j) {
+            if (r.key[j] >= 0 && r.delta[j] != 0) balances[r.key[j]] += r.delta[j];
+        }
+
+        for (size_t s : succ[t]) {
+            if (--indeg[s] == 0) dispatch(s);
+        }
+    };
+
+    // crash isolation: the worker is gone, so nothing else touches its queues.
+    // Its published results are taken first; a push it died inside stays
+    // unpublished and the task counts as lost. Then it gets fresh queues and a
+    // replacement, and exactly the tasks it still owned are re-dispatched.
+    auto recover = [&](size_t w) {
+        alive[w] = 0;
+        liveWorkers--;
+        uint64_t t;
+        while (doneQueue(hdr, w)->pop(t)) complete(t);
+
+        vector<size_t> lost;
+        for (size_t i = 0; i < n; ++i)
+            if (owner[i] == w && !finished[i]) lost.push_back(i);
+        for (size_t i : lost) owner[i] = kNoOwner;
+        workQueue(hdr, w)->init(queueCapacity);
+        doneQueue(hdr, w)->init(queueCapacity);
+        outstanding[w] = 0;
+        signalled[w] = 0;
+
+        pids[w] = spawnWorker(hdr, w, 0);
+        if (pids[w] >= 0) {
+            alive[w] = 1;
+            liveWorkers++;
+            restarts++;
+        } else {
+            // no replacement: its tasks go to the workers that are left
+            metrics.log("    worker " + to_string(w) + " died and fork failed, " +
+                        to_string(liveWorkers) + " worker(s) left");
+        }
+        if (liveWorkers == 0) return false;
+        for (size_t i : lost) dispatch(i);
+        drainBacklog();
+        metrics.log("    worker " + to_string(w) + " died, re-dispatched " +
+                    to_string(lost.size()) + " task(s)");
+        redispatched += lost.size();
+        return true;
+    };
+
+    long long runUs = metrics.measureDurationUs([&]() {
+        while (completed < n) {
+            if (killEveryUs && chrono::steady_clock::now() >= nextKill) {
+                size_t w = killRng() % procs;
+                if (alive[w] && !signalled[w] && kill(pids[w], SIGKILL) == 0) {
+                    signalled[w] = 1;   // a zombie accepts signals too; count each death once
+                    kills++;
+                }
+                nextKill = chrono::steady_clock::now() + chrono::microseconds(killEveryUs);
+            }
+
+            bool progress = false;
+            for (size_t w = 0; w < procs; ++w) {
+                uint64_t t;
+                while (doneQueue(hdr, w)->pop(t)) {
+                    complete(t);
+                    progress = true;
+                }
+            }
+            if (progress) {
+                idle = 0;
+                drainBacklog();
+                continue;
+            }
+
+            if ((idle & 255) == 255) {
+                // reap only this executor's workers
+                for (size_t w = 0; w < procs; ++w) {
+                    int status = 0;
+                    if (!alive[w] || waitpid(pids[w], &status, WNOHANG) != pids[w]) continue;
+                    if (!recover(w)) {
+                        failed = true;
+                        return;
+                    }
+                }
+            }
+            backoff(idle);
+        }
+    });
+    stopWorkers(hdr, pids);
+    if (failed) {
+        metrics.log("multiprocess failed: every worker died and none could be forked; state untouched");
+        return false;
+    }
+
+    for (size_t k = 0; k < keyNames.size(); ++k) state.setBalance(keyNames[k], balances[k]);
+
+    long long txPerSec = runUs > 0 ? (long long)(n * 1000000.0 / runUs) : 0;
+    metrics.log("multiprocess workers=" + to_string(procs) +
+                " txs=" + to_string(n) +
+                " restarts=" + to_string(restarts) +
+                " redispatched=" + to_string(redispatched) +
+                " kills=" + to_string(kills) +
+                " runUs=" + to_string(runUs) +
+                " txPerSec=" + to_string(txPerSec));
+    metrics.log("=== Multi-process Execution End ===");
+    return true;
+#endif
+}
+
+void MultiProcessExecutor::measureHandoffLatency(size_t tasks, Metrics &metrics) {
+#ifndef DIPETRANS_HAVE_SHM
+    (void)tasks;
+    metrics.log("handoff unavailable: no POSIX shared memory on this platform");
+#else
+    if (tasks == 0) return;
+
+    // one worker, one task in flight: pure round-trip latency
+    SharedSegment seg;
+    ShmHeader *hdr = layoutSegment(seg, 0, 0, 1, 64);
+    if (!hdr) return;
+    ShmQueue *work = workQueue(hdr, 0);
+    ShmQueue *done = doneQueue(hdr, 0);
+
+    cout.flush();
+    vector<pid_t> pids{spawnWorker(hdr, 0, 0)};
+    if (pids[0] < 0) {
+        metrics.log("handoff unavailable: fork failed");
+        return;
+    }
+    long long shmUs = metrics.measureDurationUs([&]() {
+        for (size_t i = 0; i < tasks; ++i) {
+            pushWithBackoff(work, kPingTask);
+            uint64_t v;
+            unsigned idle = 0;
+            while (!done->pop(v)) backoff(idle);
+        }
+    });
+    stopWorkers(hdr, pids);
+
+    ThreadPool pool(1);
+    atomic<bool> flag(false);
+    long long poolUs = metrics.measureDurationUs([&]() {
+        for (size_t i = 0; i < tasks; ++i) {
+            flag.store(false, memory_order_relaxed);
+            pool.enqueue([&flag]() { flag.store(true, memory_order_release); });
+            unsigned idle = 0;
+            while (!flag.load(memory_order_acquire)) backoff(idle);
+        }
+    });
+    pool.waitAll();
+
+    long long shmNs = shmUs * 1000 / (long long)tasks;
+    long long poolNs = poolUs * 1000 / (long long)tasks;
+    metrics.log("handoff tasks=" + to_string(tasks) +
+                " shmAvgNs=" + to_string(shmNs) +
+                " poolAvgNs=" + to_string(poolNs));
+    cout << "\nHandoff round trip: shared memory " << shmNs << " ns, ThreadPool " << poolNs << " ns\n";
+#endif
+}
+
+void MultiProcessExecutor::measureScaling(DAG &dag, vector<Transaction> &txs, const State &state,
+                                          size_t maxWorkers, Metrics &metrics) {
+    if (txs.empty()) return;
+    cout << "\nScaling (tx/s, setup included)\n" << right << setw(8) << "workers"
+         << setw(14) << "processes" << setw(14) << "pool" << "\n";
+    for (size_t w = 1; w <= max<size_t>(1, maxWorkers); w *= 2) {
+        State procState = state;
+        MultiProcessExecutor mp(w);
+        bool ok = true;
+        long long procUs = metrics.measureDurationUs([&]() { ok = mp.execute(dag, txs, procState, metrics); });
+
+        State poolState = state;
+        Executor executor;
+        long long poolUs = metrics.measureDurationUs([&]() {
+            executor.execute(ExecutionMode::DependencyDriven, dag, txs, poolState, w, metrics);
+        });
+
+        long long procTps = ok && procUs > 0 ? (long long)(txs.size() * 1000000.0 / procUs) : 0;
+        long long poolTps = poolUs > 0 ? (long long)(txs.size() * 1000000.0 / poolUs) : 0;
+        bool same = procState.getBalances() == poolState.getBalances();
+        cout << setw(8) << w << setw(14) << procTps << setw(14) << poolTps
+             << (ok ? (same ? "" : "  MISMATCH") : "  (processes unavailable)") << "\n";
+        metrics.log("multiprocess scaling workers=" + to_string(w) +
+                    " procTxPerSec=" + to_string(procTps) +
+                    " poolTxPerSec=" + to_string(poolTps) +
+                    " state=" + (same ? string("ok") : string("mismatch")));
+        if (!ok) break;
+    }
+}
@@ -0,0 +1,549 @@
+// OutOfCoreExecutor.cpp
+#include "OutOfCoreExecutor.h"
+#include "Executor.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define DIPETRANS_HAVE_MMAP 1
+#endif
+
+using namespace std;
+
+OutOfCoreExecutor::OutOfCoreExecutor(const SpillConfig &cfg)
+    : config(cfg),
+      stagingPath(cfg.dir + "/staging.bin"),
+      levelPath(cfg.dir + "/levels.bin") {}
+
+OutOfCoreExecutor::~OutOfCoreExecutor() {
+    if (staging) fclose(staging);
+    error_code ec;
+    filesystem::remove(stagingPath, ec);
+    filesystem::remove(levelPath, ec);
+    // only if empty: files the user put there are never touched
+    if (createdDir) filesystem::remove(config.dir, ec);
+}
+
+#ifdef DIPETRANS_HAVE_MMAP
+
+namespace {
+
+// On-disk record: header, id, then the read and write keys as (u16 length,
+// bytes), each set in its iteration order so the first key is the one
+// evaluateTransaction would use. Records are padded to 8 bytes.
+struct RecordHeader {
+    int64_t timestamp;
+    uint32_t bytes;
+    uint32_t level;
+    int32_t fee;
+    uint16_t idLen;
+    uint16_t readCount;
+    uint16_t writeCount;
+    uint16_t reserved;
+    uint32_t reserved2;
+};
+static_assert(sizeof(RecordHeader) == 32, "record header layout");
+
+const size_t kChunkTxs = 64;              // transactions per pool task
+
+// Per-level counters: levelBytes and levelTxs while adding and executing,
+// plus seal's output offsets (start, cursor, written) and bucket fill
+const size_t kAddLevelBytes = 2 * sizeof(uint64_t);
+const size_t kSealLevelBytes = 6 * sizeof(uint64_t);
+const size_t kExecLevelBytes = 3 * sizeof(uint64_t);
+
+size_t pageSize() {
+    static size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return page;
+}
+
+RecordHeader readHeader(const char *p) {
+    RecordHeader h;
+    memcpy(&h, p, sizeof(h));
+    return h;
+}
+
+// Returns the key starting at p and advances p past it
+string readKey(const char *&p) {
+    uint16_t len;
+    memcpy(&len, p, sizeof(len));
+    string key(p + sizeof(len), len);
+    p += sizeof(len) + len;
+    return key;
+}
+
+void skipKey(const char *&p) {
+    uint16_t len;
+    memcpy(&len, p, sizeof(len));
+    p += sizeof(len) + len;
+}
+
+bool writeAll(int fd, const char *data, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t n = pwrite(fd, data, len, (off_t)offset);
+        if (n <= 0) return false;
+        data += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return true;
+}
+
+// One level's records in the executing segment, split into kChunkTxs tasks
+struct LevelRun {
+    vector<const char*> records;
+    State *state;
+    mutex *stateMutex;
+};
+
+void runSpilledChunk(void *ctx, size_t chunk) {
+    LevelRun &run = *static_cast<LevelRun*>(ctx);
+    size_t end = min(run.records.size(), (chunk + 1) * kChunkTxs);
+    StateDelta local;
+    for (size_t i = chunk * kChunkTxs; i < end; ++i) {
+        const char *rec = run.records[i];
+        RecordHeader h = readHeader(rec);
+        const char *p = rec + sizeof(RecordHeader) + h.idLen;
+        string from, to;
+        for (uint16_t k = 0; k < h.readCount; ++k) {
+            if (k == 0) from = readKey(p);
+            else skipKey(p);
+        }
+        if (h.writeCount > 0) to = readKey(p);
+        // levels are conflict-free, so the chunk's deltas can be summed first
+        for (auto &d : evaluateTransfer(from, to)) local[d.first] += d.second;
+    }
+    lock_guard<mutex> lock(*run.stateMutex);
+    run.state->applyDelta(local);
+}
+
+} // namespace
+
+size_t OutOfCoreExecutor::bufferBytes(size_t perLevel) const {
+    uint64_t bookkeeping = (uint64_t)levelBytes.size() * perLevel;
+    uint64_t left = config.memoryBudgetBytes > bookkeeping ? config.memoryBudgetBytes - bookkeeping : 0;
+    // below a few pages the windows stop making progress; the overrun shows in peakBudgetedBytes
+    return (size_t)max<uint64_t>(left, 16 * pageSize());
+}
+
+void OutOfCoreExecutor::chargeBudget(uint64_t bytes) {
+    stats.peakBudgetedBytes = max(stats.peakBudgetedBytes, bytes);
+}
+
+bool OutOfCoreExecutor::add(const Transaction &tx) {
+    if (sealed) return false;
+    auto start = chrono::steady_clock::now();
+    if (!staging) {
+        error_code ec;
+        createdDir = !filesystem::exists(config.dir, ec);
+        filesystem::create_directories(config.dir, ec);
+        staging = fopen(stagingPath.c_str(), "wb");
+        if (!staging) return false;
+        // half the budget for the key-level table, an eighth (up to 1 MB) for stdio
+        stagingBufferBytes = min<size_t>(1u << 20, max<size_t>(config.memoryBudgetBytes / 8, 4096));
+        setvbuf(staging, nullptr, _IOFBF, stagingBufferBytes);
+        size_t slots = 1024;
+        while (slots * 2 * sizeof(KeyLevels) <= config.memoryBudgetBytes / 2) slots *= 2;
+        keyLevels.assign(slots, KeyLevels());
+        stats.keySlots = slots;
+    }
+    // the record stores lengths and counts as uint16 and its size as uint32;
+    // anything that does not fit is rejected before the key levels change
+    if (tx.getId().size() > UINT16_MAX || tx.getReadSet().size() > UINT16_MAX ||
+        tx.getWriteSet().size() > UINT16_MAX) return false;
+    size_t bytes = sizeof(RecordHeader) + tx.getId().size();
+    for (auto &k : tx.getReadSet()) {
+        if (k.size() > UINT16_MAX) return false;
+        bytes += sizeof(uint16_t) + k.size();
+    }
+    for (auto &k : tx.getWriteSet()) {
+        if (k.size() > UINT16_MAX) return false;
+        bytes += sizeof(uint16_t) + k.size();
+    }
+    bytes = (bytes + 7) & ~size_t(7);
+    if (bytes > UINT32_MAX) return false;
+
+    // level = 1 + highest level among earlier conflicting transactions: the
+    // last writer of anything touched, and every reader of anything written
+    const size_t mask = keyLevels.size() - 1;
+    hash<string> slotOf;
+    uint32_t level = 0;
+    for (auto &k : tx.getReadSet()) level = max(level, keyLevels[slotOf(k) & mask].lastWrite);
+    for (auto &k : tx.getWriteSet()) {
+        const KeyLevels &kl = keyLevels[slotOf(k) & mask];
+        level = max({level, kl.lastWrite, kl.maxRead});
+    }
+    for (auto &k : tx.getReadSet()) {
+        KeyLevels &kl = keyLevels[slotOf(k) & mask];
+        kl.maxRead = max(kl.maxRead, level + 1);
+    }
+    for (auto &k : tx.getWriteSet()) keyLevels[slotOf(k) & mask].lastWrite = level + 1;
+
+    RecordHeader h = {};
+    h.timestamp = tx.getTimestamp();
+    h.bytes = (uint32_t)bytes;
+    h.level = level;
+    h.fee = tx.getFee();
+    h.idLen = (uint16_t)tx.getId().size();
+    h.readCount = (uint16_t)tx.getReadSet().size();
+    h.writeCount = (uint16_t)tx.getWriteSet().size();
+
+    static thread_local vector<char> buf;
+    buf.assign(bytes, 0);
+    char *p = buf.data();
+    memcpy(p, &h, sizeof(h));
+    p += sizeof(h);
+    memcpy(p, tx.getId().data(), tx.getId().size());
+    p += tx.getId().size();
+    auto putKey = [&p](const string &k) {
+        uint16_t len = (uint16_t)k.size();
+        memcpy(p, &len, sizeof(len));
+        memcpy(p + sizeof(len), k.data(), k.size());
+        p += sizeof(len) + k.size();
+    };
+    for (auto &k : tx.getReadSet()) putKey(k);
+    for (auto &k : tx.getWriteSet()) putKey(k);
+    if (fwrite(buf.data(), 1, bytes, staging) != bytes) return false;
+
+    if (levelBytes.size() <= level) {
+        levelBytes.resize(level + 1, 0);
+        levelTxs.resize(level + 1, 0);
+    }
+    levelBytes[level] += bytes;
+    levelTxs[level]++;
+    if (level + 1 == levelBytes.size())
+        chargeBudget(keyLevels.size() * sizeof(KeyLevels) + stagingBufferBytes + levelBytes.capacity() * kAddLevelBytes);
+    stats.txs++;
+    stats.bytes += bytes;
+    stats.spillUs += chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool OutOfCoreExecutor::seal(Metrics &metrics) {
+    if (sealed) return true;
+    auto start = chrono::steady_clock::now();
+    if (staging) {
+        bool ok = fclose(staging) == 0;
+        staging = nullptr;
+        if (!ok) return false;
+    }
+    keyLevels = vector<KeyLevels>();   // level assignment is done
+    levelBytes.shrink_to_fit();
+    levelTxs.shrink_to_fit();
+    sealed = true;
+
+    stats.levels = levelBytes.size();
+    for (size_t n : levelTxs) stats.maxLevelTxs = max(stats.maxLevelTxs, n);
+    const uint64_t total = stats.bytes;
+
+    // Segments are sized for execute(): lookahead + 1 mapped at once, plus the
+    // executing one's record pointers (8 bytes per record of at least 32)
+    const size_t page = pageSize();
+    size_t seg = (size_t)(bufferBytes(kExecLevelBytes) / (config.lookaheadSegments + 1.25));
+    seg = max<size_t>(64u << 10, seg - seg % page);
+    stats.segmentBytes = seg;
+
+    // seal's own share after the per-level counters and the segment cuts: half
+    // for the staging window, a quarter each for the arrivals and sorted buckets
+    const size_t cuts = (size_t)(total / seg + 1);
+    const size_t sealBytes = bufferBytes(kSealLevelBytes);
+    const size_t buffer = sealBytes - min(cuts * sizeof(uint64_t), sealBytes / 2);
+    const size_t window = max<size_t>(buffer / 2 - buffer / 2 % page, page);
+    const size_t bucketBytes = buffer / 4;
+    stats.levelBookkeepingBytes = (uint64_t)stats.levels * kSealLevelBytes;
+
+    vector<uint64_t> levelStart(levelBytes.size() + 1, 0);
+    for (size_t l = 0; l < levelBytes.size(); ++l) levelStart[l + 1] = levelStart[l] + levelBytes[l];
+
+    int out = open(levelPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) return false;
+    if (total == 0) {
+        close(out);
+        segmentStarts = {0};
+        return true;
+    }
+    int in = open(stagingPath.c_str(), O_RDONLY);
+    if (in < 0 || ftruncate(out, (off_t)total) != 0) {
+        if (in >= 0) close(in);
+        close(out);
+        return false;
+    }
+
+    // The staging file is mapped one window at a time. view(pos, len) returns
+    // [pos, pos + len) from the current window, remapping at pos's page when
+    // the range runs past it; a record larger than the window gets a window of
+    // its own size.
+    char *win = nullptr;
+    uint64_t winStart = 0;
+    size_t winLen = 0;
+    bool ok = true;
+    auto view = [&](uint64_t pos, size_t len) -> const char* {
+        if (win && pos >= winStart && pos + len <= winStart + winLen) return win + (pos - winStart);
+        if (win) munmap(win, winLen);
+        winStart = pos - pos % page;
+        winLen = (size_t)min<uint64_t>(max<uint64_t>(window, pos - winStart + len), total - winStart);
+        void *p = mmap(nullptr, winLen, PROT_READ, MAP_PRIVATE, in, (off_t)winStart);
+        if (p == MAP_FAILED) {
+            win = nullptr;
+            ok = false;
+            return nullptr;
+        }
+        win = static_cast<char*>(p);
+        madvise(win, winLen, MADV_SEQUENTIAL);
+        return win + (pos - winStart);
+    };
+
+    // One pass over the staging file. Records are copied into `arrivals` in
+    // block order; when it is full they are counting-sorted by level into
+    // `sorted` and each level's run is written at that level's next offset in
+    // the output. Every byte is read once and written once. The pass also
+    // records, for every segment-grid offset, the first record start at or
+    // after it: those become the segment boundaries.
+    vector<char> arrivals, sorted;
+    arrivals.reserve(bucketBytes);
+    sorted.resize(bucketBytes);
+    vector<uint64_t> cursor(levelStart.begin(), levelStart.end() - 1);    // next record's output offset
+    vector<uint64_t> written(levelStart.begin(), levelStart.end() - 1);   // end of the level's flushed run
+    vector<uint64_t> pending(levelBytes.size(), 0);
+    vector<uint32_t> touched;
+    vector<uint64_t> cut(cuts, total);
+    chargeBudget(stats.levelBookkeepingBytes + window + 2 * bucketBytes + cut.size() * sizeof(uint64_t));
+
+    auto flush = [&]() {
+        if (arrivals.empty()) return;
+        uint64_t at = 0;
+        for (uint32_t l : touched) {
+            uint64_t bytes = pending[l];
+            pending[l] = at;   // becomes the level's fill offset in `sorted`
+            at += bytes;
+        }
+        for (size_t pos = 0; pos < arrivals.size();) {
+            RecordHeader h = readHeader(arrivals.data() + pos);
+            memcpy(sorted.data() + pending[h.level], arrivals.data() + pos, h.bytes);
+            pending[h.level] += h.bytes;
+            pos += h.bytes;
+        }
+        uint64_t from = 0;
+        for (uint32_t l : touched) {
+            uint64_t bytes = pending[l] - from;
+            ok = ok && writeAll(out, sorted.data() + from, bytes, written[l]);
+            written[l] += bytes;
+            from = pending[l];
+            pending[l] = 0;
+        }
+        touched.clear();
+        arrivals.clear();
+        stats.bucketFlushes++;
+    };
+
+    for (uint64_t pos = 0; pos < total && ok;) {
+        const char *rec = view(pos, sizeof(RecordHeader));
+        if (!rec) break;
+        RecordHeader h = readHeader(rec);
+        rec = view(pos, h.bytes);
+        if (!rec) break;
+        uint64_t d = cursor[h.level], e = d + h.bytes;
+        cursor[h.level] = e;
+        for (uint64_t g = (d + seg - 1) / seg; g < cut.size() && g * seg < e; ++g)
+            cut[g] = g * seg == d ? d : e;
+
+        if (arrivals.size() + h.bytes > bucketBytes) flush();
+        if (h.bytes > bucketBytes) {
+            // larger than the buckets: its level's earlier records were just flushed
+            ok = ok && writeAll(out, rec, h.bytes, d);
+            written[h.level] = e;
+        } else {
+            if (pending[h.level] == 0) touched.push_back(h.level);
+            pending[h.level] += h.bytes;
+            arrivals.insert(arrivals.end(), rec, rec + h.bytes);
+        }
+        pos += h.bytes;
+    }
+    if (ok) flush();
+    arrivals = vector<char>();
+    sorted = vector<char>();
+    if (win) munmap(win, winLen);
+    close(in);
+    close(out);
+    error_code ec;
+    filesystem::remove(stagingPath, ec);
+    if (!ok) return false;
+
+    segmentStarts.clear();
+    for (uint64_t c : cut)
+        if (c < total && (segmentStarts.empty() || c > segmentStarts.back())) segmentStarts.push_back(c);
+    segmentStarts.push_back(total);
+    stats.segments = segmentStarts.size() - 1;
+    stats.sealUs = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+
+    metrics.log("outofcore sealed txs=" + to_string(stats.txs) + " levels=" + to_string(stats.levels) +
+                " bytes=" + to_string(total) + " segments=" + to_string(stats.segments) +
+                " flushes=" + to_string(stats.bucketFlushes) + " sealUs=" + to_string(stats.sealUs));
+    return true;
+}
+
+bool OutOfCoreExecutor::execute(State &state, size_t threads, Metrics &metrics) {
+    if (!sealed && !seal(metrics)) return false;
+    auto start = chrono::steady_clock::now();
+    const size_t nseg = segmentStarts.size() - 1;
+    int fd = open(levelPath.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    vector<uint64_t> levelStart(1, 0);
+    for (uint64_t b : levelBytes) levelStart.push_back(levelStart.back() + b);
+
+    struct Mapped {
+        char *base = nullptr;
+        size_t len = 0;
+        size_t skew = 0;          // segment start minus its page-aligned mapping start
+        bool ready = false;
+    };
+    vector<Mapped> maps(nseg);
+    mutex m;
+    condition_variable cv;
+    size_t executing = 0;
+    bool stop = false, failed = false;
+    uint64_t mappedBytes = 0;
+
+    // maps and pages in up to lookaheadSegments past the executing one
+    thread prefetcher([&]() {
+        const size_t page = pageSize();
+        for (size_t s = 0; s < nseg; ++s) {
+            {
+                unique_lock<mutex> lock(m);
+                cv.wait(lock, [&]() { return stop || s <= executing + config.lookaheadSegments; });
+                if (stop) return;
+            }
+            uint64_t off = segmentStarts[s], aligned = off - off % page;
+            size_t len = (size_t)(segmentStarts[s + 1] - aligned);
+            void *p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, (off_t)aligned);
+            if (p != MAP_FAILED) {
+                madvise(p, len, MADV_WILLNEED);
+                volatile char sink = 0;
+                for (size_t i = 0; i < len; i += page) sink = sink + static_cast<char*>(p)[i];
+            }
+            lock_guard<mutex> lock(m);
+            if (p == MAP_FAILED) {
+                failed = true;
+                cv.notify_all();
+                return;
+            }
+            maps[s] = Mapped{static_cast<char*>(p), len, (size_t)(off - aligned), true};
+            mappedBytes += len;
+            stats.peakMappedBytes = max(stats.peakMappedBytes, mappedBytes);
+            cv.notify_all();
+        }
+    });
+
+    ThreadPool pool(threads);
+    mutex stateMutex;
+    LevelRun run{{}, &state, &stateMutex};
+    auto drain = [&]() {
+        if (run.records.empty()) return;
+        size_t chunks = (run.records.size() + kChunkTxs - 1) / kChunkTxs;
+        pool.reserve(chunks);
+        for (size_t c = 0; c < chunks; ++c) pool.enqueue(runSpilledChunk, &run, c);
+        pool.waitAll();
+        run.records.clear();
+    };
+
+    uint32_t currentLevel = UINT32_MAX;
+    bool ok = true;
+    for (size_t s = 0; s < nseg; ++s) {
+        Mapped seg;
+        {
+            unique_lock<mutex> lock(m);
+            if (!maps[s].ready) stats.prefetchStalls++;
+            cv.wait(lock, [&]() { return failed || maps[s].ready; });
+            if (!maps[s].ready) { ok = false; break; }
+            seg = maps[s];
+        }
+
+        const char *p = seg.base + seg.skew;
+        const char *end = seg.base + seg.len;
+        while (p < end) {
+            RecordHeader h = readHeader(p);
+            if (h.level != currentLevel) {
+                drain();
+                if (currentLevel != UINT32_MAX) stats.barriers++;
+                currentLevel = h.level;
+            }
+            run.records.push_back(p);
+            p += h.bytes;
+        }
+
+        // the records point into this mapping, so the pool drains before unmapping
+        drain();
+        if (!binary_search(levelStart.begin(), levelStart.end(), segmentStarts[s + 1])) stats.segmentDrains++;
+        munmap(seg.base, seg.len);
+        lock_guard<mutex> lock(m);
+        mappedBytes -= seg.len;
+        maps[s] = Mapped();
+        executing = s + 1;
+        cv.notify_all();
+    }
+    if (currentLevel != UINT32_MAX) stats.barriers++;
+
+    {
+        lock_guard<mutex> lock(m);
+        stop = true;
+        cv.notify_all();
+    }
+    prefetcher.join();
+    chargeBudget((uint64_t)stats.levels * kExecLevelBytes + stats.peakMappedBytes +
+                 run.records.capacity() * sizeof(const char*) + segmentStarts.size() * sizeof(uint64_t));
+    for (auto &mp : maps) if (mp.ready) munmap(mp.base, mp.len);
+    close(fd);
+
+    stats.executeUs = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        stats.peakRssBytes = (uint64_t)usage.ru_maxrss;
+#else
+        stats.peakRssBytes = (uint64_t)usage.ru_maxrss * 1024;
+#endif
+    }
+    long long txPerSec = stats.executeUs > 0 ? (long long)(stats.txs * 1000000.0 / stats.executeUs) : 0;
+    metrics.log("outofcore txs=" + to_string(stats.txs) +
+                " threads=" + to_string(threads) +
+                " memoryBudgetBytes=" + to_string(config.memoryBudgetBytes) +
+                " peakBudgetedBytes=" + to_string(stats.peakBudgetedBytes) +
+                " keySlots=" + to_string(stats.keySlots) +
+                " segmentBytes=" + to_string(stats.segmentBytes) +
+                " lookahead=" + to_string(config.lookaheadSegments) +
+                " spillUs=" + to_string(stats.spillUs) +
+                " sealUs=" + to_string(stats.sealUs) +
+                " executeUs=" + to_string(stats.executeUs) +
+                " txPerSec=" + to_string(txPerSec) +
+                " peakMappedBytes=" + to_string(stats.peakMappedBytes) +
+                " peakRssBytes=" + to_string(stats.peakRssBytes) +
+                " barriers=" + to_string(stats.barriers) +
+                " segmentDrains=" + to_string(stats.segmentDrains) +
+                " stalls=" + to_string(stats.prefetchStalls) +
+                " ok=" + (ok ? string("1") : string("0")));
+    return ok;
+}
+
+#else
+
+bool OutOfCoreExecutor::add(const Transaction &) { return false; }
+bool OutOfCoreExecutor::seal(Metrics &metrics) {
+    metrics.log("outofcore unavailable: no mmap on this platform");
+    return false;
+}
+bool OutOfCoreExecutor::execute(State &, size_t, Metrics &) { return false; }
+
+#endif
@@ -0,0 +1,165 @@
+// Partitioner.cpp
+#include "Partitioner.h"
+#include <unordered_set>
+#include <set>
+#include <tuple>
+#include <algorithm>
+using namespace std;
+
+string partitionStrategyName(PartitionStrategy strategy) {
+    switch (strategy) {
+        case PartitionStrategy::Greedy: return "greedy";
+        case PartitionStrategy::DSatur: return "dsatur";
+    }
+    return "unknown";
+}
+
+bool parsePartitionStrategy(const string &name, PartitionStrategy &strategy) {
+    if (name == "greedy") { strategy = PartitionStrategy::Greedy; return true; }
+    if (name == "dsatur") { strategy = PartitionStrategy::DSatur; return true; }
+    return false;
+}
+
+bool transactionsConflict(const Transaction &A, const Transaction &B) {
+    for (const auto &w : A.getWriteSet()) {
+        if (B.getReadSet().count(w)) return true;
+    }
+    for (const auto &w : A.getWriteSet()) {
+        if (B.getWriteSet().count(w)) return true;
+    }
+    for (const auto &r : A.getReadSet()) {
+        if (B.getWriteSet().count(r)) return true;
+    }
+    return false;
+}
+
+static vector<vector<string>> partitionGreedy(
+    const vector<string> &batch,
+    const unordered_map<string, const Transaction*> &lookup
+) {
+    vector<vector<string>> groups;
+    for (const auto &txid : batch) {
+        const Transaction &tx = *lookup.at(txid);
+        bool placed = false;
+        for (auto &group : groups) {
+            bool conflict_with_group = false;
+            for (const auto &memberId : group) {
+                const Transaction &memberTx = *lookup.at(memberId);
+                if (transactionsConflict(tx, memberTx) || transactionsConflict(memberTx, tx)) {
+                    conflict_with_group = true;
+                    break;
+                }
+            }
+            if (!conflict_with_group) {
+                group.push_back(txid);
+                placed = true;
+                break;
+            }
+        }
+        if (!placed) groups.push_back(vector<string>{txid});
+    }
+    return groups;
+}
+
+// Conflict graph of the batch from a key index (members sharing a key that at
+// least one of them writes), then DSatur: colour the vertex with the most
+// distinctly coloured neighbours first, with the lowest colour it may take.
+// Levelling group sizes instead (to the smallest group, or to the pool's
+// rounds) kept the group count but made the partition benchmark's makespan up
+// to a third slower, so the early groups are left to fill up as in greedy.
+static vector<vector<string>> partitionDSatur(
+    const vector<string> &batch,
+    const unordered_map<string, const Transaction*> &lookup
+) {
+    const size_t n = batch.size();
+    unordered_map<string, vector<size_t>> readers, writers;
+    for (size_t i = 0; i < n; ++i) {
+        const Transaction &tx = *lookup.at(batch[i]);
+        for (auto &k : tx.getReadSet()) readers[k].push_back(i);
+        for (auto &k : tx.getWriteSet()) writers[k].push_back(i);
+    }
+
+    vector<vector<size_t>> nbr(n);
+    size_t edges = 0;
+    auto link = [&](size_t a, size_t b) {
+        if (a == b) return;
+        nbr[a].push_back(b);
+        nbr[b].push_back(a);
+        edges++;
+    };
+    for (auto &p : writers) {
+        const auto &ws = p.second;
+        for (size_t x = 0; x < ws.size(); ++x)
+            for (size_t y = x + 1; y < ws.size(); ++y) link(ws[x], ws[y]);
+        auto r = readers.find(p.first);
+        if (r == readers.end()) continue;
+        for (size_t w : ws)
+            for (size_t rd : r->second) link(w, rd);
+    }
+
+    // batches cut from a complete conflict DAG have no internal conflicts
+    if (edges == 0) return {batch};
+
+    for (auto &v : nbr) {
+        sort(v.begin(), v.end());
+        v.erase(unique(v.begin(), v.end()), v.end());
+    }
+
+    vector<int> color(n, -1);
+    vector<unordered_set<int>> neighborColors(n);
+    vector<size_t> groupSize;
+
+    // ordered by (saturation desc, degree desc, batch position asc)
+    set<tuple<long, long, size_t>> queue;
+    for (size_t i = 0; i < n; ++i) queue.emplace(0, -(long)nbr[i].size(), i);
+
+    while (!queue.empty()) {
+        size_t v = get<2>(*queue.begin());
+        queue.erase(queue.begin());
+
+        int chosen = -1;
+        for (int c = 0; c < (int)groupSize.size(); ++c) {
+            if (!neighborColors[v].count(c)) {
+                chosen = c;
+                break;
+            }
+        }
+        if (chosen < 0) {
+            chosen = (int)groupSize.size();
+            groupSize.push_back(0);
+        }
+        color[v] = chosen;
+        groupSize[chosen]++;
+
+        for (size_t u : nbr[v]) {
+            if (color[u] >= 0 || neighborColors[u].count(chosen)) continue;
+            queue.erase(make_tuple(-(long)neighborColors[u].size(), -(long)nbr[u].size(), u));
+            neighborColors[u].insert(chosen);
+            queue.emplace(-(long)neighborColors[u].size(), -(long)nbr[u].size(), u);
+        }
+    }
+
+    // groups keep batch order inside, so output stays deterministic
+    vector<vector<string>> groups(groupSize.size());
+    for (size_t i = 0; i < n; ++i) groups[color[i]].push_back(batch[i]);
+    return groups;
+}
+
+vector<vector<string>> partitionIntoConflictFreeGroups(
+    const vector<string> &batch,
+    const unordered_map<string, const Transaction*> &lookup,
+    PartitionStrategy strategy
+) {
+    switch (strategy) {
+        case PartitionStrategy::DSatur: return partitionDSatur(batch, lookup);
+        case PartitionStrategy::Greedy: break;
+    }
+    return partitionGreedy(batch, lookup);
+}
+
+size_t partitionRounds(const vector<vector<string>> &groups, size_t threads) {
+    threads = max<size_t>(1, threads);
+    size_t rounds = 0;
+    for (auto &g : groups) rounds += (g.size() + threads - 1) / threads;
+    return rounds;
+}
@@ -0,0 +1,204 @@
+// PerfCounters.cpp
+#include "PerfCounters.h"
+#include "Metrics.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define DIPETRANS_HAVE_PERF 1
+#endif
+
+using namespace std;
+
+void CounterSet::add(const CounterSet &o) {
+    cycles += o.cycles;
+    instructions += o.instructions;
+    llcMisses += o.llcMisses;
+    contextSwitches += o.contextSwitches;
+    taskClockNs += o.taskClockNs;
+    userUs += o.userUs;
+    sysUs += o.sysUs;
+    hardware = hardware || o.hardware;
+    llc = llc || o.llc;
+    software = software || o.software;
+}
+
+static void readRusage(bool thread, uint64_t &userUs, uint64_t &sysUs, uint64_t &ctx) {
+    struct rusage ru;
+#if defined(RUSAGE_THREAD)
+    int who = thread ? RUSAGE_THREAD : RUSAGE_SELF;
+#else
+    int who = RUSAGE_SELF;
+    (void)thread;
+#endif
+    if (getrusage(who, &ru) != 0) {
+        userUs = sysUs = ctx = 0;
+        return;
+    }
+    userUs = (uint64_t)ru.ru_utime.tv_sec * 1000000 + (uint64_t)ru.ru_utime.tv_usec;
+    sysUs = (uint64_t)ru.ru_stime.tv_sec * 1000000 + (uint64_t)ru.ru_stime.tv_usec;
+    ctx = (uint64_t)(ru.ru_nvcsw + ru.ru_nivcsw);
+}
+
+#ifdef DIPETRANS_HAVE_PERF
+static int openEvent(uint32_t type, uint64_t config, bool inherit) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = inherit ? 1 : 0;
+    attr.exclude_hv = 1;
+    // context switches happen in the kernel, so try counting it first;
+    // perf_event_paranoid 2 only allows user-space counting
+    int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd >= 0) return fd;
+    attr.exclude_kernel = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+PerfCounters::PerfCounters(bool includeNewThreads) : inherit(includeNewThreads) {
+    for (int &fd : fds) fd = -1;
+#ifdef DIPETRANS_HAVE_PERF
+    fds[Cycles] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, inherit);
+    fds[Instructions] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, inherit);
+    // PERF_COUNT_HW_CACHE_MISSES is whatever the PMU calls "cache misses"; ask for LL read misses
+    fds[LlcMisses] = openEvent(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL |
+                               (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), inherit);
+    fds[ContextSwitches] = openEvent(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, inherit);
+    fds[TaskClock] = openEvent(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, inherit);
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef DIPETRANS_HAVE_PERF
+    for (int fd : fds) if (fd >= 0) close(fd);
+#endif
+}
+
+void PerfCounters::start() {
+    // a phase that spawns threads is charged for the whole process by getrusage
+    readRusage(!inherit, userUs0, sysUs0, ctx0);
+#ifdef DIPETRANS_HAVE_PERF
+    for (int fd : fds) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+    running = true;
+}
+
+CounterSet PerfCounters::stop() {
+    CounterSet c;
+    if (!running) return c;
+    running = false;
+
+    uint64_t values[EventCount] = {};
+    bool have[EventCount] = {};
+#ifdef DIPETRANS_HAVE_PERF
+    for (int e = 0; e < EventCount; ++e) {
+        if (fds[e] < 0) continue;
+        ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+        have[e] = read(fds[e], &values[e], sizeof(uint64_t)) == (ssize_t)sizeof(uint64_t);
+    }
+#endif
+
+    uint64_t userUs, sysUs, ctx;
+    readRusage(!inherit, userUs, sysUs, ctx);
+    c.userUs = userUs - userUs0;
+    c.sysUs = sysUs - sysUs0;
+
+    c.hardware = have[Cycles] && have[Instructions];
+    c.cycles = values[Cycles];
+    c.instructions = values[Instructions];
+    c.llc = have[LlcMisses];
+    c.llcMisses = values[LlcMisses];
+
+    c.software = have[ContextSwitches] || have[TaskClock];
+    c.contextSwitches = have[ContextSwitches] ? values[ContextSwitches] : ctx - ctx0;
+    c.taskClockNs = have[TaskClock] ? values[TaskClock] : (c.userUs + c.sysUs) * 1000;
+    return c;
+}
+
+PerfProfiler& PerfProfiler::get() {
+    static PerfProfiler inst;
+    return inst;
+}
+
+void PerfProfiler::recordPhase(const string &phase, long long wallUs, const CounterSet &c) {
+    lock_guard<mutex> lock(m);
+    auto it = phases.find(phase);
+    if (it == phases.end()) {
+        order.push_back(phase);
+        it = phases.emplace(phase, PhaseTotals()).first;
+    }
+    it->second.calls++;
+    it->second.wallUs += wallUs;
+    it->second.counters.add(c);
+}
+
+void PerfProfiler::recordWorker(long long wallUs, const CounterSet &c) {
+    lock_guard<mutex> lock(m);
+    workers++;
+    workerWallUs += wallUs;
+    workerTotals.add(c);
+}
+
+static string counterFields(const CounterSet &c) {
+    ostringstream o;
+    o << "source=" << c.source();
+    if (c.hardware) {
+        double ipc = c.cycles ? (double)c.instructions / (double)c.cycles : 0.0;
+        o << " cycles=" << c.cycles << " instructions=" << c.instructions
+          << " ipc=" << fixed << setprecision(2) << ipc;
+    }
+    if (c.llc) o << " llcMisses=" << c.llcMisses;
+    o << " ctxSwitches=" << c.contextSwitches
+      << " taskClockUs=" << c.taskClockNs / 1000
+      << " userUs=" << c.userUs << " sysUs=" << c.sysUs;
+    return o.str();
+}
+
+void PerfProfiler::writeSummary(Metrics &metrics) {
+    if (!enabled()) return;
+    lock_guard<mutex> lock(m);
+
+    ostringstream table;
+    table << "\n" << left << setw(14) << "phase" << right << setw(7) << "calls" << setw(11) << "wallUs"
+          << setw(14) << "cycles" << setw(8) << "ipc" << setw(12) << "llcMisses"
+          << setw(10) << "ctxSw" << setw(11) << "cpuUs" << "  source\n";
+    auto row = [&](const string &name, size_t calls, long long wallUs, const CounterSet &c) {
+        double ipc = c.cycles ? (double)c.instructions / (double)c.cycles : 0.0;
+        table << left << setw(14) << name << right << setw(7) << calls << setw(11) << wallUs;
+        if (c.hardware) table << setw(14) << c.cycles << setw(8) << fixed << setprecision(2) << ipc;
+        else table << setw(14) << "-" << setw(8) << "-";
+        if (c.llc) table << setw(12) << c.llcMisses;
+        else table << setw(12) << "-";
+        table << setw(10) << c.contextSwitches << setw(11) << c.taskClockNs / 1000 << "  " << c.source() << "\n";
+    };
+
+    for (auto &name : order) {
+        const PhaseTotals &p = phases[name];
+        metrics.log("perf phase=" + name + " calls=" + to_string(p.calls) +
+                    " wallUs=" + to_string(p.wallUs) + " " + counterFields(p.counters));
+        row(name, p.calls, p.wallUs, p.counters);
+    }
+    if (workers > 0) {
+        metrics.log("perf workers=" + to_string(workers) + " wallUs=" + to_string(workerWallUs) + " " +
+                    counterFields(workerTotals));
+        row("workers", workers, workerWallUs, workerTotals);
+    }
+    cout << table.str();
+}
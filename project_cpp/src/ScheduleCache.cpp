@@ -0,0 +1,207 @@
+// ScheduleCache.cpp
+#include "ScheduleCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+using namespace std;
+
+static const uint32_t kScheduleMagic = 0x43535044;   // "DPSC"
+static const uint32_t kScheduleVersion = 1;
+
+BlockShape computeBlockShape(const vector<Transaction> &txs, PartitionStrategy strategy) {
+    BlockShape shape;
+    unordered_map<string, uint32_t> keyIds;
+    vector<const string*> names;
+    vector<uint32_t> ids;
+
+    auto appendSet = [&](const unordered_set<string> &set) {
+        names.clear();
+        for (auto &k : set) names.push_back(&k);
+        sort(names.begin(), names.end(), [](const string *a, const string *b) { return *a < *b; });
+        ids.clear();
+        for (const string *k : names) {
+            auto it = keyIds.emplace(*k, (uint32_t)keyIds.size()).first;
+            ids.push_back(it->second);
+        }
+        sort(ids.begin(), ids.end());
+        shape.canonical.insert(shape.canonical.end(), ids.begin(), ids.end());
+    };
+
+    shape.canonical.reserve(txs.size() * 4 + 1);
+    for (auto &tx : txs) {
+        shape.canonical.push_back((uint32_t)tx.getReadSet().size());
+        shape.canonical.push_back((uint32_t)tx.getWriteSet().size());
+        appendSet(tx.getReadSet());
+        appendSet(tx.getWriteSet());
+    }
+    shape.canonical.push_back((uint32_t)strategy);
+
+    // FNV-1a over the canonical words
+    uint64_t h = 1469598103934665603ull;
+    for (uint32_t w : shape.canonical) {
+        for (int b = 0; b < 4; ++b) {
+            h ^= (w >> (8 * b)) & 0xff;
+            h *= 1099511628211ull;
+        }
+    }
+    shape.fingerprint = h;
+    return shape;
+}
+
+bool scheduleValidFor(const Schedule &schedule, const vector<Transaction> &txs) {
+    const size_t n = txs.size();
+    const uint32_t unset = (uint32_t)-1;
+
+    // sequence number of the group each position runs in
+    vector<uint32_t> seqOf(n, unset);
+    uint32_t seq = 0;
+    for (auto &batch : schedule) {
+        for (auto &group : batch) {
+            for (uint32_t p : group) {
+                if (p >= n || seqOf[p] != unset) return false;
+                seqOf[p] = seq;
+            }
+            ++seq;
+        }
+    }
+    for (uint32_t s : seqOf) if (s == unset) return false;
+
+    // walking the block in order, a writer must come after every earlier access
+    // to its keys, a reader after every earlier write
+    struct KeyState { int64_t lastAny = -1, lastWrite = -1; };
+    unordered_map<string, KeyState> keys;
+    for (size_t i = 0; i < n; ++i) {
+        int64_t s = seqOf[i];
+        for (auto &k : txs[i].getWriteSet()) {
+            KeyState &ks = keys[k];
+            if (ks.lastAny >= s) return false;
+        }
+        for (auto &k : txs[i].getReadSet()) {
+            KeyState &ks = keys[k];
+            if (ks.lastWrite >= s) return false;
+        }
+        for (auto &k : txs[i].getReadSet()) {
+            KeyState &ks = keys[k];
+            ks.lastAny = max(ks.lastAny, s);
+        }
+        for (auto &k : txs[i].getWriteSet()) {
+            KeyState &ks = keys[k];
+            ks.lastAny = max(ks.lastAny, s);
+            ks.lastWrite = max(ks.lastWrite, s);
+        }
+    }
+    return true;
+}
+
+ScheduleCache::ScheduleCache(const string &d) : dir(d) {
+    if (!dir.empty()) {
+        error_code ec;
+        filesystem::create_directories(dir, ec);
+    }
+}
+
+bool ScheduleCache::lookup(const BlockShape &shape, const vector<Transaction> &txs, Schedule &out, long long &buildUs) {
+    auto start = chrono::steady_clock::now();
+    lookups++;
+
+    auto it = entries.find(shape.fingerprint);
+    if (it == entries.end()) {
+        Entry e;
+        if (!load(shape.fingerprint, e)) return false;
+        it = entries.emplace(shape.fingerprint, move(e)).first;
+    }
+
+    const Entry &e = it->second;
+    if (e.canonical != shape.canonical || !scheduleValidFor(e.schedule, txs)) {
+        rejected++;
+        return false;
+    }
+
+    out = e.schedule;
+    buildUs = e.buildUs;
+    hits++;
+    long long checkUs = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    savedUs += e.buildUs - checkUs;
+    return true;
+}
+
+void ScheduleCache::insert(const BlockShape &shape, const Schedule &schedule, long long buildUs) {
+    Entry &e = entries[shape.fingerprint];
+    e.canonical = shape.canonical;
+    e.schedule = schedule;
+    e.buildUs = buildUs;
+    save(shape.fingerprint, e);
+}
+
+string ScheduleCache::pathFor(uint64_t fingerprint) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.sched", (unsigned long long)fingerprint);
+    return dir + "/" + name;
+}
+
+template <typename T>
+static void writePod(ofstream &out, const T &v) { out.write(reinterpret_cast<const char*>(&v), sizeof(T)); }
+
+template <typename T>
+static bool readPod(ifstream &in, T &v) { return (bool)in.read(reinterpret_cast<char*>(&v), sizeof(T)); }
+
+static void writeWords(ofstream &out, const vector<uint32_t> &v) {
+    writePod(out, (uint64_t)v.size());
+    out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(uint32_t));
+}
+
+static bool readWords(ifstream &in, vector<uint32_t> &v) {
+    uint64_t n;
+    if (!readPod(in, n) || n > (1ull << 28)) return false;   // corrupt length
+    v.resize(n);
+    return (bool)in.read(reinterpret_cast<char*>(v.data()), n * sizeof(uint32_t));
+}
+
+void ScheduleCache::save(uint64_t fingerprint, const Entry &e) const {
+    if (dir.empty()) return;
+    string tmp = pathFor(fingerprint) + ".tmp";
+    {
+        ofstream out(tmp, ios::binary | ios::trunc);
+        if (!out.is_open()) return;
+        writePod(out, kScheduleMagic);
+        writePod(out, kScheduleVersion);
+        writePod(out, fingerprint);
+        writePod(out, (int64_t)e.buildUs);
+        writeWords(out, e.canonical);
+        writePod(out, (uint64_t)e.schedule.size());
+        for (auto &batch : e.schedule) {
+            writePod(out, (uint64_t)batch.size());
+            for (auto &group : batch) writeWords(out, group);
+        }
+    }
+    rename(tmp.c_str(), pathFor(fingerprint).c_str());
+}
+
+bool ScheduleCache::load(uint64_t fingerprint, Entry &e) const {
+    if (dir.empty()) return false;
+    ifstream in(pathFor(fingerprint), ios::binary);
+    if (!in.is_open()) return false;
+
+    uint32_t magic, version;
+    uint64_t stored, batches;
+    int64_t buildUs;
+    if (!readPod(in, magic) || magic != kScheduleMagic) return false;
+    if (!readPod(in, version) || version != kScheduleVersion) return false;
+    if (!readPod(in, stored) || stored != fingerprint) return false;
+    if (!readPod(in, buildUs) || !readWords(in, e.canonical)) return false;
+    if (!readPod(in, batches)) return false;
+    e.buildUs = buildUs;
+    e.schedule.clear();
+    for (uint64_t b = 0; b < batches; ++b) {
+        uint64_t groups;
+        if (!readPod(in, groups)) return false;
+        e.schedule.emplace_back();
+        for (uint64_t g = 0; g < groups; ++g) {
+            e.schedule.back().emplace_back();
+            if (!readWords(in, e.schedule.back().back())) return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,420 @@
+// Simulator.cpp
+#include "Simulator.h"
+#include "Components.h"
+#include "Coarsening.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <unordered_map>
+using namespace std;
+
+static double elapsedNs(chrono::steady_clock::time_point since) {
+    return (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - since).count();
+}
+
+// A level of transaction tasks writing delta slots, as runLevelOnPool submits them
+struct BurstJob {
+    const vector<Transaction> *txs;
+    IndexRange level;
+    vector<TxDelta> *slots;
+
+    static void run(void *ctx, size_t i) {
+        BurstJob &j = *static_cast<BurstJob*>(ctx);
+        (*j.slots)[i] = evaluateTransaction((*j.txs)[j.level[i]]);
+    }
+};
+
+// The DAG released from the workers, as executeDependencyDriven runs it
+struct ChainJob {
+    const vector<Transaction> *txs;
+    const IndexedDAG *graph;
+    atomic<int> *indeg;
+    State *state;
+    mutex *stateMutex;
+    ThreadPool *pool;
+
+    static void run(void *ctx, size_t i) {
+        ChainJob &j = *static_cast<ChainJob*>(ctx);
+        TxDelta delta = evaluateTransaction((*j.txs)[i]);
+        {
+            lock_guard<mutex> lock(*j.stateMutex);
+            j.state->applyDelta(delta);
+        }
+        for (size_t s : j.graph->successors(i))
+            if (j.indeg[s].fetch_sub(1, memory_order_acq_rel) == 1) j.pool->enqueue(&ChainJob::run, ctx, s);
+    }
+};
+
+CostModel CostModel::constant(size_t txCount, double ns, double dispatchNs, double barrierNs) {
+    CostModel m;
+    m.kind = CostModelKind::Constant;
+    m.txNs.assign(txCount, ns);
+    m.dispatchNs = dispatchNs;
+    m.barrierNs = barrierNs;
+    return m;
+}
+
+CostModel CostModel::sampled(size_t txCount, const vector<double> &samples, unsigned seed) {
+    CostModel m;
+    m.kind = CostModelKind::Sampled;
+    m.txNs.resize(txCount, 0.0);
+    if (samples.empty()) return m;
+    mt19937 rng(seed);
+    uniform_int_distribution<size_t> pick(0, samples.size() - 1);
+    for (auto &c : m.txNs) c = samples[pick(rng)];
+    return m;
+}
+
+CostModel CostModel::calibrate(const vector<Transaction> &txs, Metrics &metrics, double observedTxNs) {
+    CostModel m;
+    m.kind = CostModelKind::Calibrated;
+    m.txNs.resize(txs.size());
+
+    // each tx timed over a few repetitions: a single call is below clock resolution
+    const int reps = 8;
+    for (size_t i = 0; i < txs.size(); ++i) {
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r) evaluateTransaction(txs[i]);
+        m.txNs[i] = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / (double)reps;
+    }
+    double evalNs = m.meanTxNs();
+    if (observedTxNs > 0 && evalNs > 0)
+        for (auto &c : m.txNs) c *= observedTxNs / evalNs;
+    const double txMeanNs = m.meanTxNs();
+    m.chargeSetup = true;
+
+    // thread spawn + join: batches pays one per extra chunk and level, a pool one per worker
+    const size_t spawns = 200;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < spawns; ++i) thread([]() {}).join();
+    m.spawnNs = elapsedNs(start) / spawns;
+
+    // barrier: waitAll on one empty task, minus that task's own dispatch
+    ThreadPool pool(1);
+    atomic<size_t> sink(0);
+    const size_t emptyTasks = 20000, barriers = 2000;
+    auto noop = [](void *ctx, size_t) { static_cast<atomic<size_t>*>(ctx)->fetch_add(1, memory_order_relaxed); };
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < emptyTasks; ++i) pool.enqueue(noop, &sink, i);
+    pool.waitAll();
+    double emptyNs = elapsedNs(start) / emptyTasks;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < barriers; ++i) {
+        pool.enqueue(noop, &sink, i);
+        pool.waitAll();
+    }
+    m.barrierNs = max(0.0, elapsedNs(start) / barriers - emptyNs);
+
+    metrics.log("simcal txs=" + to_string(txs.size()) +
+                " evalNs=" + to_string((long long)evalNs) +
+                " meanTxNs=" + to_string((long long)txMeanNs) +
+                " barrierNs=" + to_string((long long)m.barrierNs) +
+                " spawnNs=" + to_string((long long)m.spawnNs));
+    return m;
+}
+
+string CostModel::name() const {
+    switch (kind) {
+        case CostModelKind::Constant: return "constant";
+        case CostModelKind::Sampled: return "sampled";
+        case CostModelKind::Calibrated: return "calibrated";
+    }
+    return "unknown";
+}
+
+double CostModel::meanTxNs() const {
+    if (txNs.empty()) return 0.0;
+    double sum = 0.0;
+    for (double c : txNs) sum += c;
+    return sum / (double)txNs.size();
+}
+
+ScheduleSimulator::ScheduleSimulator(const DAG &d, const vector<Transaction> &t, PartitionStrategy partition)
+    : dag(d), txs(t) {
+    // timed the way buildIndexedGraph builds it for dependency and coarse
+    auto start = chrono::steady_clock::now();
+    graph = indexDAG(dag, txs);
+    indexSetupNs = elapsedNs(start);
+
+    // the same levels the real strategies derive, timed like resolveLevels
+    // (which indexes the DAG itself)
+    start = chrono::steady_clock::now();
+    levels = topologicalLevels(indexDAG(dag, txs));
+    levelSetupNs = elapsedNs(start);
+
+    // waves partitions the DAG's own id levels
+    unordered_map<string, size_t> position;
+    for (size_t i = 0; i < txs.size(); ++i) position[txs[i].getId()] = i;
+    unordered_map<string, const Transaction*> lookup;
+    for (auto &tx : txs) lookup[tx.getId()] = &tx;
+    vector<vector<string>> levelIds = dag.getLevels();
+    start = chrono::steady_clock::now();
+    for (auto &ids : levelIds) {
+        waves.emplace_back();
+        for (auto &group : partitionIntoConflictFreeGroups(ids, lookup, partition)) {
+            waves.back().emplace_back();
+            for (auto &id : group) waves.back().back().push_back(position.at(id));
+        }
+    }
+    partitionSetupNs = elapsedNs(start);
+}
+
+void ScheduleSimulator::calibrateDispatch(CostModel &cost, Metrics &metrics) const {
+    const size_t n = txs.size();
+    if (n == 0) return;
+    double txTotalNs = 0.0;
+    for (size_t p = 0; p < n && p < cost.txNs.size(); ++p) txTotalNs += cost.txNs[p];
+
+    // levels as bursts into delta slots, merged after each waitAll
+    ThreadPool pool(1);
+    State scratch;
+    vector<TxDelta> slots;
+    auto start = chrono::steady_clock::now();
+    for (size_t k = 0; k < levels.levels(); ++k) {
+        IndexRange level = levels.level(k);
+        slots.assign(level.size(), TxDelta());
+        BurstJob job{&txs, level, &slots};
+        for (size_t i = 0; i < level.size(); ++i) pool.enqueue(&BurstJob::run, &job, i);
+        pool.waitAll();
+        for (auto &d : slots) scratch.applyDelta(d);
+    }
+    double burstNs = elapsedNs(start) - (double)levels.levels() * cost.barrierNs;
+    cost.dispatchNs = max(0.0, (burstNs - txTotalNs) / (double)n);
+
+    // the DAG released from the workers, each delta applied under a mutex
+    unique_ptr<atomic<int>[]> indeg(new atomic<int>[n]);
+    for (size_t i = 0; i < n; ++i) indeg[i].store(0, memory_order_relaxed);
+    for (size_t t : graph.targets) indeg[t].fetch_add(1, memory_order_relaxed);
+    vector<size_t> roots;
+    for (size_t i = 0; i < n; ++i)
+        if (indeg[i].load(memory_order_relaxed) == 0) roots.push_back(i);
+    mutex stateMutex;
+    pool.reserve(n);
+    ChainJob chain{&txs, &graph, indeg.get(), &scratch, &stateMutex, &pool};
+    start = chrono::steady_clock::now();
+    for (size_t i : roots) pool.enqueue(&ChainJob::run, &chain, i);
+    pool.waitAll();
+    cost.chainDispatchNs = max(0.0, (elapsedNs(start) - cost.barrierNs - txTotalNs) / (double)n);
+
+    metrics.log("simcal dispatchNs=" + to_string((long long)cost.dispatchNs) +
+                " chainDispatchNs=" + to_string((long long)cost.chainDispatchNs) +
+                " levels=" + to_string(levels.levels()) + " roots=" + to_string(roots.size()));
+}
+
+bool ScheduleSimulator::supports(ExecutionMode mode) {
+    return mode != ExecutionMode::BatchThreads;
+}
+
+// Each phase: tasks go in order to the earliest free worker; the phase ends when
+// the last one finishes, and every worker idles from its own finish until then
+void ScheduleSimulator::simulatePhases(const vector<vector<double>> &phases, size_t workers,
+                                       const CostModel &cost, SimResult &r) const {
+    double now = 0.0;
+    for (auto &phase : phases) {
+        if (phase.empty()) continue;
+        priority_queue<double, vector<double>, greater<double>> free;
+        for (size_t w = 0; w < workers; ++w) free.push(now);
+        double end = now;
+        double busy = 0.0;
+        for (double c : phase) {
+            double start = free.top();
+            free.pop();
+            double finish = start + cost.dispatchNs + c;
+            free.push(finish);
+            end = max(end, finish);
+            busy += cost.dispatchNs + c;
+        }
+        r.barrierIdleNs += max(0.0, (end - now) * (double)workers - busy);
+        r.tasks += phase.size();
+        r.barriers++;
+        now = end + cost.barrierNs;
+    }
+    r.makespanNs = now;
+}
+
+// batches: per level the coordinator spawns one thread per extra chunk, runs
+// chunk 0 itself and joins; chunk w starts once w threads have been spawned
+void ScheduleSimulator::simulateThreadLevels(const vector<vector<double>> &levelChunks,
+                                             const CostModel &cost, SimResult &r) const {
+    double now = 0.0;
+    for (auto &chunks : levelChunks) {
+        if (chunks.empty()) continue;
+        double end = now + (double)(chunks.size() - 1) * cost.spawnNs + chunks[0];
+        double busy = chunks[0];
+        for (size_t w = 1; w < chunks.size(); ++w) {
+            end = max(end, now + (double)w * cost.spawnNs + chunks[w]);
+            busy += chunks[w];
+        }
+        r.barrierIdleNs += max(0.0, (end - now) * (double)r.workers - busy);
+        r.tasks += chunks.size();
+        r.barriers++;
+        now = end;
+    }
+    r.makespanNs = now;
+}
+
+// Discrete-event replay: ready tasks start FIFO on free workers, a task's
+// successors become ready when its last predecessor completes
+void ScheduleSimulator::simulateGraph(const vector<double> &taskNs, const IndexedDAG &taskSucc, size_t workers,
+                                      double dispatchNs, const CostModel &cost, SimResult &r) const {
+    const size_t n = taskNs.size();
+    vector<int> indeg(n, 0);
+    for (size_t v : taskSucc.targets) indeg[v]++;
+
+    deque<size_t> ready;
+    for (size_t t = 0; t < n; ++t) if (indeg[t] == 0) ready.push_back(t);
+
+    typedef pair<double, size_t> Event;   // finish time, task
+    priority_queue<Event, vector<Event>, greater<Event>> running;
+    size_t idle = workers;
+    double now = 0.0;
+    while (!ready.empty() || !running.empty()) {
+        while (idle > 0 && !ready.empty()) {
+            size_t t = ready.front();
+            ready.pop_front();
+            running.push(Event(now + dispatchNs + taskNs[t], t));
+            idle--;
+        }
+        Event e = running.top();
+        running.pop();
+        now = e.first;
+        idle++;
+        for (size_t v : taskSucc.successors(e.second))
+            if (--indeg[v] == 0) ready.push_back(v);
+    }
+    r.tasks += n;
+    r.barriers += 1;                   // the final waitAll
+    r.makespanNs = now + cost.barrierNs;
+}
+
+SimResult ScheduleSimulator::simulate(ExecutionMode mode, size_t workers, const CostModel &cost) const {
+    SimResult r;
+    r.mode = mode;
+    r.workers = mode == ExecutionMode::Sequential ? 1 : max<size_t>(1, workers);
+    for (double c : cost.txNs) r.busyNs += c;
+    const size_t n = txs.size();
+    auto txCost = [&](size_t p) { return p < cost.txNs.size() ? cost.txNs[p] : 0.0; };
+    double setupNs = 0.0;
+    bool pooled = true;   // runs on a ThreadPool that is started and stopped once
+
+    switch (mode) {
+        case ExecutionMode::Sequential:
+            r.makespanNs = r.busyNs;
+            r.tasks = n;
+            pooled = false;
+            break;
+
+        case ExecutionMode::ParallelBatches: {
+            // one contiguous chunk per worker per level, on threads spawned per level
+            vector<vector<double>> levelChunks;
+            for (size_t k = 0; k < levels.levels(); ++k) {
+                IndexRange level = levels.level(k);
+                size_t chunks = max<size_t>(1, min(r.workers, level.size()));
+                size_t per = (level.size() + chunks - 1) / chunks;
+                levelChunks.emplace_back();
+                for (size_t c = 0; c * per < level.size(); ++c) {
+                    double sum = 0.0;
+                    for (size_t i = c * per; i < min(level.size(), (c + 1) * per); ++i) sum += txCost(level[i]);
+                    levelChunks.back().push_back(sum);
+                }
+            }
+            simulateThreadLevels(levelChunks, cost, r);
+            setupNs = levelSetupNs;
+            pooled = false;
+            break;
+        }
+
+        case ExecutionMode::PriorityBatches:
+        case ExecutionMode::ThreadPoolBatches: {
+            vector<vector<double>> phases;
+            double sortNs = 0.0;
+            for (size_t k = 0; k < levels.levels(); ++k) {
+                vector<size_t> order(levels.level(k).begin(), levels.level(k).end());
+                if (mode == ExecutionMode::PriorityBatches) {
+                    auto start = chrono::steady_clock::now();
+                    sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                        if (txs[a].getFee() != txs[b].getFee()) return txs[a].getFee() > txs[b].getFee();
+                        return txs[a].getTimestamp() < txs[b].getTimestamp();
+                    });
+                    sortNs += elapsedNs(start);
+                }
+                phases.emplace_back();
+                for (size_t p : order) phases.back().push_back(txCost(p));
+            }
+            simulatePhases(phases, r.workers, cost, r);
+            setupNs = levelSetupNs + sortNs;
+            break;
+        }
+
+        case ExecutionMode::Waves: {
+            vector<vector<double>> phases;
+            for (auto &batch : waves) {
+                for (auto &group : batch) {
+                    phases.emplace_back();
+                    for (size_t p : group) phases.back().push_back(txCost(p));
+                }
+            }
+            simulatePhases(phases, r.workers, cost, r);
+            setupNs = levelSetupNs + partitionSetupNs;
+            break;
+        }
+
+        case ExecutionMode::DependencyDriven: {
+            vector<double> taskNs(n);
+            for (size_t p = 0; p < n; ++p) taskNs[p] = txCost(p);
+            simulateGraph(taskNs, graph, r.workers, cost.chainDispatchNs, cost, r);
+            setupNs = indexSetupNs;
+            break;
+        }
+
+        case ExecutionMode::Components: {
+            auto start = chrono::steady_clock::now();
+            ComponentSet set = findConnectedComponents(indexDAG(dag, txs), r.workers);
+            size_t target = max<size_t>(1, n / max<size_t>(1, r.workers * 4));
+            vector<vector<size_t>> units = packComponents(set, target);
+            setupNs = elapsedNs(start);
+            vector<double> taskNs;
+            for (auto &unit : units) {
+                double sum = 0.0;
+                for (size_t c : unit)
+                    for (size_t p : set.component(c)) sum += txCost(p);
+                taskNs.push_back(sum);
+            }
+            IndexedDAG independent;
+            independent.offsets.assign(taskNs.size() + 1, 0);
+            simulateGraph(taskNs, independent, r.workers, cost.dispatchNs, cost, r);
+            break;
+        }
+
+        case ExecutionMode::Coarsened: {
+            CoarseningPolicy policy;
+            auto start = chrono::steady_clock::now();
+            CoarsePlan plan = coarsenSchedule(graph, coarseTaskSize(policy, max(1.0, cost.meanTxNs())), r.workers);
+            setupNs = indexSetupNs + elapsedNs(start);
+            vector<double> taskNs;
+            for (size_t t = 0; t < plan.taskCount(); ++t) {
+                double sum = 0.0;
+                for (size_t p : plan.task(t)) sum += txCost(p);
+                taskNs.push_back(sum);
+            }
+            simulateGraph(taskNs, plan.succ, r.workers, cost.dispatchNs, cost, r);
+            break;
+        }
+
+        case ExecutionMode::BatchThreads:
+            pooled = false;
+            break;
+    }
+
+    if (cost.chargeSetup) r.setupNs = setupNs;
+    r.makespanNs += r.setupNs;
+    if (pooled) r.makespanNs += (double)r.workers * cost.spawnNs;
+    r.makespanNs = max(0.0, r.makespanNs + cost.runOffsetNs(mode));
+    return r;
+}
@@ -9,9 +9,17 @@ long long State::getBalance(const string &key) const {
     return it->second;
 }
 
-void State::applyDelta(const unordered_map<string, long long> &delta) {
+void State::applyDelta(const StateDelta &delta) {
     for (auto &p : delta) {
         balances[p.first] += p.second;
+        if (trackDirty) dirty.insert(p.first);
+    }
+}
+
+void State::applyDelta(const TxDelta &delta) {
+    for (auto &p : delta) {
+        balances[p.first] += p.second;
+        if (trackDirty) dirty.insert(p.first);
     }
 }
 
@@ -24,4 +32,20 @@ void State::display() const {
 
 void State::setBalance(const string &key, long long value) {
     balances[key] = value;
+    if (trackDirty) dirty.insert(key);
+}
+
+void State::eraseBalance(const string &key) {
+    if (balances.erase(key) && trackDirty) dirty.insert(key);
+}
+
+void State::setDirtyTracking(bool on) {
+    trackDirty = on;
+    if (!on) dirty.clear();
+}
+
+unordered_set<string> State::takeDirtyKeys() {
+    unordered_set<string> out;
+    out.swap(dirty);
+    return out;
 }
\ No newline at end of file
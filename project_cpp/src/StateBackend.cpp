@@ -0,0 +1,87 @@
+// StateBackend.cpp
+#include "StateBackend.h"
+using namespace std;
+
+SlowStateBackend::SlowStateBackend(chrono::microseconds latency, size_t ioDepth)
+    : coldLatency(latency), stop(false) {
+    if (ioDepth == 0) ioDepth = 1;
+    for (size_t i = 0; i < ioDepth; i++) {
+        io.emplace_back([this]() {
+            while (true) {
+                string key;
+                {
+                    unique_lock<mutex> lock(m);
+                    requestReady.wait(lock, [this] { return stop || !requests.empty(); });
+                    if (stop) return;
+                    key = move(requests.front());
+                    requests.pop_front();
+                }
+
+                this_thread::sleep_for(coldLatency);
+
+                {
+                    lock_guard<mutex> lock(m);
+                    pending.erase(key);
+                    resident.insert(key);
+                }
+                loadDone.notify_all();
+            }
+        });
+    }
+}
+
+SlowStateBackend::~SlowStateBackend() {
+    {
+        lock_guard<mutex> lock(m);
+        stop = true;
+    }
+    requestReady.notify_all();
+    for (thread &t : io) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void SlowStateBackend::load(const string &key) {
+    unique_lock<mutex> lock(m);
+    // served by the same I/O threads as prefetch, so both see the same depth
+    while (!resident.count(key)) {
+        if (!pending.count(key)) {
+            pending.insert(key);
+            requests.push_back(key);
+            requestReady.notify_one();
+        }
+        loadDone.wait(lock);
+    }
+}
+
+void SlowStateBackend::prefetch(const string &key) {
+    {
+        lock_guard<mutex> lock(m);
+        if (resident.count(key) || pending.count(key)) return;
+        pending.insert(key);
+        requests.push_back(key);
+    }
+    requestReady.notify_one();
+}
+
+bool SlowStateBackend::isResident(const string &key) const {
+    lock_guard<mutex> lock(m);
+    return resident.count(key) > 0;
+}
+
+void SlowStateBackend::waitForLoads(chrono::microseconds maxWait) {
+    unique_lock<mutex> lock(m);
+    if (pending.empty()) return;
+    loadDone.wait_for(lock, maxWait);
+}
+
+void SlowStateBackend::evictAll() {
+    unique_lock<mutex> lock(m);
+    // queued loads are dropped; loads already being served finish first, so
+    // none of them can mark a key resident after the eviction
+    for (auto &key : requests) pending.erase(key);
+    requests.clear();
+    loadDone.notify_all();   // a blocked load() re-queues its dropped request
+    loadDone.wait(lock, [this] { return pending.empty(); });
+    resident.clear();
+}
@@ -0,0 +1,208 @@
+// StateCommitment.cpp
+#include "StateCommitment.h"
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+namespace {
+
+// FIPS 180-4 SHA-256
+const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+void compress(uint32_t h[8], const uint8_t block[64]) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i)
+        w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 |
+               (uint32_t)block[4 * i + 2] << 8 | (uint32_t)block[4 * i + 3];
+    for (int i = 16; i < 64; ++i) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+    for (int i = 0; i < 64; ++i) {
+        uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        hh = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+}
+
+// Fixed-width big-endian, so a leaf hashes the same on every host
+inline void appendBigEndian(string &buf, uint64_t v, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) buf.push_back((char)(uint8_t)(v >> (8 * i)));
+}
+
+// Context for the leaf and inner-node hashing ranges
+struct LeafJob {
+    StateCommitment *self;
+    const State *state;
+    const vector<size_t> *items;
+};
+
+} // namespace
+
+Hash256 sha256(const uint8_t *data, size_t len) {
+    uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    size_t full = len / 64;
+    for (size_t i = 0; i < full; ++i) compress(h, data + 64 * i);
+
+    uint8_t tail[128] = {0};
+    size_t rest = len - full * 64;
+    memcpy(tail, data + full * 64, rest);
+    tail[rest] = 0x80;
+    size_t tailLen = rest + 9 <= 64 ? 64 : 128;
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; ++i) tail[tailLen - 1 - i] = (uint8_t)(bits >> (8 * i));
+    compress(h, tail);
+    if (tailLen == 128) compress(h, tail + 64);
+
+    Hash256 out;
+    for (int i = 0; i < 8; ++i) {
+        out[4 * i] = (uint8_t)(h[i] >> 24);
+        out[4 * i + 1] = (uint8_t)(h[i] >> 16);
+        out[4 * i + 2] = (uint8_t)(h[i] >> 8);
+        out[4 * i + 3] = (uint8_t)h[i];
+    }
+    return out;
+}
+
+string hashToHex(const Hash256 &h) {
+    static const char digits[] = "0123456789abcdef";
+    string s(64, '0');
+    for (size_t i = 0; i < 32; ++i) {
+        s[2 * i] = digits[h[i] >> 4];
+        s[2 * i + 1] = digits[h[i] & 0xf];
+    }
+    return s;
+}
+
+StateCommitment::StateCommitment(unsigned d) : depth(min(d, 24u)) {
+    leafCount = (size_t)1 << depth;
+    tree.assign(2 * leafCount, Hash256());   // all-zero: every subtree starts empty
+    buckets.resize(leafCount);
+}
+
+size_t StateCommitment::bucketOf(const string &key) const {
+    Hash256 h = sha256(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+    uint32_t top = (uint32_t)h[0] << 24 | (uint32_t)h[1] << 16 | (uint32_t)h[2] << 8 | h[3];
+    return depth == 0 ? 0 : (size_t)(top >> (32 - depth));
+}
+
+void StateCommitment::hashLeaf(const State &state, size_t bucket) {
+    const vector<string> &keys = buckets[bucket];
+    Hash256 &out = tree[leafCount + bucket];
+    if (keys.empty()) {
+        out.fill(0);
+        return;
+    }
+    string buf;
+    for (auto &k : keys) {
+        appendBigEndian(buf, (uint32_t)k.size(), 4);
+        buf.append(k);
+        appendBigEndian(buf, (uint64_t)(int64_t)state.getBalance(k), 8);   // two's complement
+    }
+    out = sha256(reinterpret_cast<const uint8_t*>(buf.data()), buf.size());
+}
+
+void StateCommitment::hashInner(size_t node) {
+    const Hash256 &l = tree[2 * node], &r = tree[2 * node + 1];
+    static const Hash256 zero = Hash256();
+    if (l == zero && r == zero) {
+        tree[node].fill(0);
+        return;
+    }
+    uint8_t buf[64];
+    memcpy(buf, l.data(), 32);
+    memcpy(buf + 32, r.data(), 32);
+    tree[node] = sha256(buf, 64);
+}
+
+// Splits [0, count) into ranges of at least kMinPerTask items on the pool
+void StateCommitment::forEachParallel(ThreadPool *pool, size_t count,
+                                      void (*fn)(void *ctx, size_t begin, size_t end), void *ctx) {
+    const size_t kMinPerTask = 256;
+    if (!pool || count < 2 * kMinPerTask) {
+        fn(ctx, 0, count);
+        return;
+    }
+    struct Range {
+        void (*fn)(void*, size_t, size_t);
+        void *ctx;
+        size_t count, per;
+        static void run(void *p, size_t i) {
+            Range &r = *static_cast<Range*>(p);
+            size_t begin = i * r.per;
+            r.fn(r.ctx, begin, min(r.count, begin + r.per));
+        }
+    };
+    Range range{fn, ctx, count, kMinPerTask};
+    size_t tasks = (count + kMinPerTask - 1) / kMinPerTask;
+    for (size_t i = 0; i < tasks; ++i) pool->enqueue(&Range::run, &range, i);
+    pool->waitAll();
+}
+
+void StateCommitment::build(const State &state, ThreadPool *pool) {
+    for (auto &b : buckets) b.clear();
+    unordered_set<string> all;
+    for (auto &p : state.getBalances()) all.insert(p.first);
+    update(state, all, pool);
+}
+
+size_t StateCommitment::update(const State &state, const unordered_set<string> &dirtyKeys, ThreadPool *pool) {
+    // membership first (serial: it mutates the bucket lists), then dirty leaves
+    vector<size_t> dirty;
+    for (auto &k : dirtyKeys) {
+        size_t b = bucketOf(k);
+        vector<string> &keys = buckets[b];
+        auto it = lower_bound(keys.begin(), keys.end(), k);
+        bool listed = it != keys.end() && *it == k;
+        bool exists = state.getBalances().count(k) > 0;   // erased keys leave their bucket
+        if (exists && !listed) keys.insert(it, k);
+        else if (!exists && listed) keys.erase(it);
+        dirty.push_back(b);
+    }
+    sort(dirty.begin(), dirty.end());
+    dirty.erase(unique(dirty.begin(), dirty.end()), dirty.end());
+
+    LeafJob job{this, &state, &dirty};
+    forEachParallel(pool, dirty.size(), [](void *ctx, size_t begin, size_t end) {
+        LeafJob &j = *static_cast<LeafJob*>(ctx);
+        for (size_t i = begin; i < end; ++i) j.self->hashLeaf(*j.state, (*j.items)[i]);
+    }, &job);
+    size_t hashed = dirty.size();
+
+    // walk up one level at a time; nodes of a level are independent
+    vector<size_t> level;
+    level.reserve(dirty.size());
+    for (size_t b : dirty) level.push_back(leafCount + b);
+    while (level.size() > 1 || (level.size() == 1 && level[0] > 1)) {
+        vector<size_t> parents;
+        parents.reserve(level.size());
+        for (size_t node : level) {
+            size_t parent = node / 2;
+            if (parents.empty() || parents.back() != parent) parents.push_back(parent);
+        }
+        job.items = &parents;
+        forEachParallel(pool, parents.size(), [](void *ctx, size_t begin, size_t end) {
+            LeafJob &j = *static_cast<LeafJob*>(ctx);
+            for (size_t i = begin; i < end; ++i) j.self->hashInner((*j.items)[i]);
+        }, &job);
+        hashed += parents.size();
+        level.swap(parents);
+    }
+    return hashed;
+}
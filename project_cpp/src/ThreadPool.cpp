@@ -1,25 +1,43 @@
 #include "ThreadPool.h"
+#include "LiveStats.h"
+#include "PerfCounters.h"
 #include <iostream>
 #include <chrono>
+#include <optional>
 using namespace std;
 
-ThreadPool::ThreadPool(size_t threads) : stop(false), activeTasks(0) {
+ThreadPool::ThreadPool(size_t threads)
+    : ring(64), head(0), count(0), stop(false), activeTasks(0), queuedTasks(0), liveStatsSource(-1) {
+    liveStatsSource = LiveStats::get().addGaugeSource(
+        [this]() { return (uint64_t)queuedTasks.load(memory_order_relaxed); },
+        [this]() { return (uint64_t)activeTasks.load(memory_order_relaxed); });
+
     for (size_t i = 0; i < threads; i++) {
         workers.emplace_back([this]() {
-            while (true) {
-                function<void()> task;
+            // per-worker lifetime counters, only opened when profiling (app --perf)
+            optional<PerfCounters> lifetime;
+            chrono::steady_clock::time_point born;
+            if (PerfProfiler::get().enabled()) {
+                lifetime.emplace(false);
+                lifetime->start();
+                born = chrono::steady_clock::now();
+            }
 
+            PoolTask task;
+            while (true) {
                 {
                     unique_lock<mutex> lock(this->queueMutex);
                     this->condition.wait(lock, [this] {
-                        return stop || !tasks.empty();
+                        return stop || count != 0;
                     });
 
-                    if (stop && tasks.empty())
-                        return;
+                    if (stop && count == 0)
+                        break;
 
-                    task = move(tasks.front());
-                    tasks.pop();
+                    task = move(ring[head]);
+                    head = (head + 1) % ring.size();
+                    --count;
+                    queuedTasks.fetch_sub(1, memory_order_relaxed);
                     activeTasks.fetch_add(1, memory_order_relaxed);
                 }
 
@@ -29,31 +47,69 @@ ThreadPool::ThreadPool(size_t threads) : stop(false), activeTasks(0) {
                 } catch (...) {
                     // swallow exceptions for demo
                 }
+                task.reset();
 
-                activeTasks.fetch_sub(1, memory_order_relaxed);
+                {
+                    // decrement under the lock so waitAll() cannot miss the wakeup
+                    lock_guard<mutex> lock(this->queueMutex);
+                    activeTasks.fetch_sub(1, memory_order_relaxed);
+                }
                 // after finishing a task, notify any waiters
                 condition.notify_all();
             }
+
+            if (lifetime) {
+                CounterSet counters = lifetime->stop();
+                PerfProfiler::get().recordWorker(
+                    chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - born).count(),
+                    counters);
+            }
         });
     }
 }
 
-void ThreadPool::enqueue(function<void()> task) {
+// caller holds no lock
+void ThreadPool::push(PoolTask &&task) {
     {
         lock_guard<mutex> lock(queueMutex);
-        tasks.push(task);
+        if (count == ring.size()) {
+            // unroll the ring into a buffer twice the size
+            vector<PoolTask> bigger(ring.size() * 2);
+            for (size_t i = 0; i < count; ++i)
+                bigger[i] = move(ring[(head + i) % ring.size()]);
+            ring.swap(bigger);
+            head = 0;
+        }
+        ring[(head + count) % ring.size()] = move(task);
+        ++count;
+        queuedTasks.fetch_add(1, memory_order_relaxed);
     }
     condition.notify_one();
 }
 
+void ThreadPool::enqueue(void (*fn)(void *ctx, size_t index), void *ctx, size_t index) {
+    push(PoolTask([fn, ctx, index]() { fn(ctx, index); }));
+}
+
+void ThreadPool::reserve(size_t tasks) {
+    lock_guard<mutex> lock(queueMutex);
+    if (tasks <= ring.size()) return;
+    vector<PoolTask> bigger(tasks);
+    for (size_t i = 0; i < count; ++i)
+        bigger[i] = move(ring[(head + i) % ring.size()]);
+    ring.swap(bigger);
+    head = 0;
+}
+
 void ThreadPool::waitAll() {
     unique_lock<mutex> lock(queueMutex);
     condition.wait(lock, [this]() {
-        return tasks.empty() && activeTasks.load(memory_order_relaxed) == 0;
+        return count == 0 && activeTasks.load(memory_order_relaxed) == 0;
     });
 }
 
 ThreadPool::~ThreadPool() {
+    LiveStats::get().removeGaugeSource(liveStatsSource);
     {
         lock_guard<mutex> lock(queueMutex);
         stop = true;
@@ -63,4 +119,4 @@ ThreadPool::~ThreadPool() {
         if (t.joinable())
             t.join();
     }
-}
\ No newline at end of file
+}
@@ -1,18 +1,259 @@
 // TraceWriter.cpp
 #include "TraceWriter.h"
 #include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
 
 TraceWriter& TraceWriter::get() {
     static TraceWriter inst;
     return inst;
 }
 
+// batch_start / group_start / group_merged carry "batchId":N; other events
+// belong to the batch that was last announced
+static bool findBatchId(const std::string &ev, long long &batch) {
+    static const std::string key = "\"batchId\":";
+    size_t pos = ev.find(key);
+    if (pos == std::string::npos) return false;
+    batch = std::strtoll(ev.c_str() + pos + key.size(), nullptr, 10);
+    return true;
+}
+
+// Raw (still escaped) value of a "key":"..." string field
+static bool findString(const std::string &ev, const std::string &key, std::string &out) {
+    size_t pos = ev.find(key);
+    if (pos == std::string::npos) return false;
+    size_t begin = pos + key.size(), end = begin;
+    while (end < ev.size() && ev[end] != '"') end += ev[end] == '\\' ? 2 : 1;
+    out.assign(ev, begin, end - begin);
+    return true;
+}
+
+// Raw elements of a "key":["a","b"] string array, passed to fn one at a time
+template <class Fn>
+static void forEachString(const std::string &ev, const std::string &key, Fn fn) {
+    size_t pos = ev.find(key);
+    if (pos == std::string::npos) return;
+    size_t i = pos + key.size();
+    std::string item;
+    while (i < ev.size() && ev[i] != ']') {
+        if (ev[i] != '"') { ++i; continue; }
+        size_t end = ++i;
+        while (end < ev.size() && ev[end] != '"') end += ev[end] == '\\' ? 2 : 1;
+        item.assign(ev, i, end - i);
+        fn(item);
+        i = end + 1;
+    }
+}
+
+// Same transitions as applyEvent in gui/index.html. Only the open chunk's
+// changes are kept here; writeChunk folds them into the full states.
+void TraceWriter::trackNodeStates(const std::string &ev) {
+    std::string type, id;
+    if (!findString(ev, "\"type\":\"", type)) return;
+    if (type == "batch_start") {
+        forEachString(ev, "\"batch\":[", [&](const std::string &tx) { changed.state[tx] = "ready"; });
+    } else if (type == "group_start") {
+        forEachString(ev, "\"group\":[", [&](const std::string &tx) { changed.state[tx] = "running"; });
+    } else if (type == "tx_eval" && findString(ev, "\"txId\":\"", id)) {
+        changed.state[id] = "done";
+        std::string thread;
+        if (findString(ev, "\"threadId\":\"", thread)) changed.thread[id] = thread;
+    }
+}
+
 void TraceWriter::pushEvent(const std::string &jsonEvent) {
-    std::lock_guard<std::mutex> lg(m);
-    events.push_back(jsonEvent);
+    std::unique_lock<std::mutex> lg(m);
+    if (!chunked) {
+        events.push_back(jsonEvent);
+        return;
+    }
+
+    // stamped under the lock, so "ts" is non-decreasing in file order
+    long long ts = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - origin).count();
+    findBatchId(jsonEvent, currentBatch);
+    if (events.empty()) {
+        chunkStartUs = ts;
+        chunkFirstBatch = currentBatch;
+    }
+    lastUs = ts;
+    trackNodeStates(jsonEvent);
+
+    std::string stamped = "{\"ts\":" + std::to_string(ts);
+    if (jsonEvent.size() > 2) stamped += ",";
+    stamped.append(jsonEvent, jsonEvent.empty() ? 0 : 1, std::string::npos);
+    events.push_back(std::move(stamped));
+
+    if (events.size() < perChunk) return;
+
+    pending.push_back(sealChunk());
+    lg.unlock();
+    writePending(false);
+}
+
+// Writes every chunk handed off so far, in seal order. Whichever pusher gets
+// writeMutex first writes the others' chunks too; the rest find nothing left.
+void TraceWriter::writePending(bool complete) {
+    std::lock_guard<std::mutex> wl(writeMutex);
+    std::vector<SealedChunk> ready;
+    {
+        std::lock_guard<std::mutex> lg(m);
+        ready.swap(pending);
+    }
+    if (ready.empty() && !complete) return;
+    for (auto &chunk : ready) writeChunk(chunk);
+    writeIndex(complete);
+}
+
+TraceWriter::SealedChunk TraceWriter::sealChunk() {
+    SealedChunk c;
+    char name[32];
+    std::snprintf(name, sizeof(name), "chunk_%05zu.json", chunkCount);
+    c.info.file = name;
+    std::snprintf(name, sizeof(name), "keyframe_%05zu.json", chunkCount++);
+    c.info.keyframe = name;
+    c.changed = std::move(changed);
+    changed = NodeStates();
+    c.info.firstEvent = sealedEvents;
+    c.info.events = events.size();
+    c.info.tStartUs = chunkStartUs;
+    c.info.tEndUs = lastUs;
+    c.info.firstBatch = chunkFirstBatch;
+    c.info.lastBatch = currentBatch;
+    c.events.swap(events);
+    events.reserve(perChunk);
+    sealedEvents += c.info.events;
+    return c;
+}
+
+void TraceWriter::writeChunk(const SealedChunk &chunk) {
+    std::ofstream out(dir + "/" + chunk.info.file, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) return;
+    out << "[\n";
+    for (size_t i = 0; i < chunk.events.size(); ++i) {
+        out << chunk.events[i];
+        if (i + 1 < chunk.events.size()) out << ",\n";
+        else out << "\n";
+    }
+    out << "]\n";
+
+    // This chunk's keyframe is the state after the chunks before it. A delta
+    // holds what the previous chunk changed; once the deltas since the last
+    // full keyframe would outgrow a full one, write a full one instead.
+    ChunkInfo info = chunk.info;
+    size_t delta = lastChanged.state.size() + lastChanged.thread.size();
+    size_t full = writtenNodes.state.size() + writtenNodes.thread.size();
+    info.fullKeyframe = index.empty() || deltaEntries + delta >= full;
+    if (info.fullKeyframe) {
+        writeKeyframe(info.keyframe, writtenNodes, true);
+        deltaEntries = 0;
+    } else {
+        writeKeyframe(info.keyframe, lastChanged, false);
+        deltaEntries += delta;
+    }
+
+    for (auto &p : chunk.changed.state) writtenNodes.state[p.first] = p.second;
+    for (auto &p : chunk.changed.thread) writtenNodes.thread[p.first] = p.second;
+    lastChanged = chunk.changed;
+    index.push_back(info);
+}
+
+void TraceWriter::writeKeyframe(const std::string &file, const NodeStates &states, bool full) {
+    std::ofstream kf(dir + "/" + file, std::ios::out | std::ios::trunc);
+    if (!kf.is_open()) return;
+    kf << "{\"full\":" << (full ? "true" : "false") << ",\"states\":{";
+    bool first = true;
+    for (auto &p : states.state) {
+        kf << (first ? "" : ",") << "\"" << p.first << "\":\"" << p.second << "\"";
+        first = false;
+    }
+    kf << "},\"threads\":{";
+    first = true;
+    for (auto &p : states.thread) {
+        kf << (first ? "" : ",") << "\"" << p.first << "\":\"" << p.second << "\"";
+        first = false;
+    }
+    kf << "}}\n";
+}
+
+// rewritten after every chunk (a few dozen bytes per chunk), so a viewer can follow a live run
+void TraceWriter::writeIndex(bool complete) {
+    size_t total = index.empty() ? 0 : index.back().firstEvent + index.back().events;
+    std::string tmp = dir + "/index.json.tmp";
+    {
+        std::ofstream out(tmp, std::ios::out | std::ios::trunc);
+        if (!out.is_open()) return;
+        out << "{\"version\":1,\"eventsPerChunk\":" << perChunk
+            << ",\"totalEvents\":" << total
+            << ",\"complete\":" << (complete ? "true" : "false")
+            << ",\"chunks\":[\n";
+        for (size_t i = 0; i < index.size(); ++i) {
+            const ChunkInfo &c = index[i];
+            out << "{\"file\":\"" << c.file << "\",\"keyframe\":\"" << c.keyframe
+                << "\",\"fullKeyframe\":" << (c.fullKeyframe ? "true" : "false")
+                << ",\"firstEvent\":" << c.firstEvent
+                << ",\"events\":" << c.events
+                << ",\"tStartUs\":" << c.tStartUs << ",\"tEndUs\":" << c.tEndUs
+                << ",\"firstBatch\":" << c.firstBatch << ",\"lastBatch\":" << c.lastBatch << "}"
+                << (i + 1 < index.size() ? ",\n" : "\n");
+        }
+        out << "]}\n";
+    }
+    std::rename(tmp.c_str(), (dir + "/index.json").c_str());
+}
+
+bool TraceWriter::openChunked(const std::string &path, size_t eventsPerChunk) {
+    std::error_code ec;
+    std::filesystem::create_directories(path, ec);
+    if (ec) return false;
+
+    // drop chunks of an earlier run so the directory matches the new index
+    for (auto &entry : std::filesystem::directory_iterator(path, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("chunk_", 0) == 0 || name.rfind("keyframe_", 0) == 0)
+            std::filesystem::remove(entry.path(), ec);
+    }
+
+    std::lock_guard<std::mutex> wl(writeMutex);
+    std::unique_lock<std::mutex> lg(m);
+    chunked = true;
+    dir = path;
+    perChunk = eventsPerChunk == 0 ? 4096 : eventsPerChunk;
+    origin = std::chrono::steady_clock::now();
+    events.clear();
+    events.reserve(perChunk);
+    pending.clear();
+    sealedEvents = 0;
+    chunkCount = 0;
+    currentBatch = 0;
+    changed = NodeStates();
+    index.clear();
+    writtenNodes = NodeStates();
+    lastChanged = NodeStates();
+    deltaEntries = 0;
+    lg.unlock();
+    writeIndex(false);
+    return true;
+}
+
+void TraceWriter::close() {
+    std::unique_lock<std::mutex> lg(m);
+    if (!chunked) return;
+    if (!events.empty()) pending.push_back(sealChunk());
+    chunked = false;
+    changed = NodeStates();
+    // same hand-off as pushEvent: file I/O happens after m is released
+    lg.unlock();
+    writePending(true);
 }
 
 void TraceWriter::flushToFile(const std::string &path) {
+    if (isChunked()) {
+        close();
+        return;
+    }
     std::lock_guard<std::mutex> lg(m);
     std::ofstream out(path, std::ios::out | std::ios::trunc);
     if (!out.is_open()) return;
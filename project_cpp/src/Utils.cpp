@@ -1,5 +1,6 @@
 // Utils.cpp
 #include "Utils.h"
+#include <random>
 using namespace std;
 
 vector<Transaction> createSampleTransactions() {
@@ -75,3 +76,39 @@ State createInitialState() {
     init["Z"] = 0;   // new account for Tx8
     return State(init);
 }
+
+vector<Transaction> createSyntheticTransactions(size_t count, size_t keyCount, double hotKeyRatio, unsigned seed) {
+    vector<Transaction> txs;
+    txs.reserve(count);
+    forEachSyntheticTransaction(count, keyCount, hotKeyRatio, seed,
+                                [&](const Transaction &tx) { txs.push_back(tx); });
+    return txs;
+}
+
+void forEachSyntheticTransaction(size_t count, size_t keyCount, double hotKeyRatio, unsigned seed,
+                                 const function<void(const Transaction &)> &fn) {
+    if (keyCount < 2) keyCount = 2;
+
+    mt19937 rng(seed);
+    uniform_int_distribution<size_t> anyKey(0, keyCount - 1);
+    uniform_real_distribution<double> coin(0.0, 1.0);
+    uniform_int_distribution<int> feeDist(1, 100);
+
+    for (size_t i = 0; i < count; i++) {
+        size_t from = coin(rng) < hotKeyRatio ? 0 : anyKey(rng);
+        size_t to = anyKey(rng);
+        while (to == from) to = anyKey(rng);
+
+        fn(Transaction("Tx" + to_string(i + 1),
+            unordered_set<string>{"K" + to_string(from)},
+            unordered_set<string>{"K" + to_string(to)},
+            feeDist(rng), 1000 + (long long)i));
+    }
+}
+
+State createSyntheticState(size_t keyCount, long long initialBalance) {
+    unordered_map<string, long long> init;
+    init.reserve(keyCount);
+    for (size_t k = 0; k < keyCount; k++) init["K" + to_string(k)] = initialBalance;
+    return State(init);
+}
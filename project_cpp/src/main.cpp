@@ -5,8 +5,17 @@
 #include <iomanip>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <cmath>
 #include <unordered_map>
 #include <unordered_set>
+#include <atomic>
+#include <mutex>
+#include <cstdlib>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <thread>
 
 #include "Transaction.h"
 #include "DAG.h"
@@ -16,9 +25,50 @@
 #include "Metrics.h"
 #include "Utils.h"
 #include "TraceWriter.h"
+#include "MultiProcessExecutor.h"
+#include "IncrementalExecutor.h"
+#include "LiveStats.h"
+#include "ThreadPool.h"
+#include "PerfCounters.h"
+#include "StateCommitment.h"
+#include "Simulator.h"
+#include "OutOfCoreExecutor.h"
+#include "AllocCounter.h"
 
 using namespace std;
 
+static void noopTask(void *ctx, size_t index) {
+    static_cast<atomic<size_t>*>(ctx)->fetch_add(index & 1, memory_order_relaxed);
+}
+
+// Submits `rounds` bursts of `tasks` (function, index) tasks; the first burst
+// warms the ring, the rest must not allocate.
+static void measurePoolAllocations(size_t threads, size_t tasks, size_t rounds, Metrics &metrics) {
+    ThreadPool pool(threads);
+    atomic<size_t> sink(0);
+    for (size_t i = 0; i < tasks; ++i) pool.enqueue(&noopTask, &sink, i);
+    pool.waitAll();
+
+    uint64_t allocs = 0;
+    long long us = metrics.measureDurationUs([&]() {
+        uint64_t before = allocationCount();
+        for (size_t r = 1; r < rounds; ++r) {
+            for (size_t i = 0; i < tasks; ++i) pool.enqueue(&noopTask, &sink, i);
+            pool.waitAll();
+        }
+        allocs = allocationCount() - before;
+    });
+    size_t submitted = tasks * (rounds > 0 ? rounds - 1 : 0);
+
+    bool counted = allocationCountingEnabled();
+    metrics.log("pooltasks tasks=" + to_string(submitted) +
+                " allocs=" + (counted ? to_string(allocs) : string("n/a")) +
+                " avgNs=" + to_string(submitted ? us * 1000 / (long long)submitted : 0));
+    cout << "ThreadPool submission path: " << submitted << " tasks, ";
+    if (counted) cout << allocs << " heap allocations\n";
+    else cout << "allocations not counted (build with -DDIPETRANS_COUNT_ALLOCS)\n";
+}
+
 static string toJsonStringArray(const unordered_set<string> &s) {
     ostringstream o;
     o << "[";
@@ -91,13 +141,565 @@ static void exportAugmentedDagJSON(const DAG &dag, const vector<Transaction> &tx
     cout << "Wrote augmented DAG JSON to " << path << "\n";
 }
 
+// Transfers commute, so equal final balances cannot show a reordered schedule.
+// This untimed run records the order in which transactions are evaluated. It
+// then checks every conflicting pair against block order. On arrival of
+// position p: each key p writes must not have been touched by a later position
+// yet, and each key p reads must not have been written by one.
+static bool checkApplyOrder(Executor &executor, ExecutionMode mode, DAG &dag, vector<Transaction> &txs,
+                            const State &state, size_t threads, Metrics &metrics) {
+    unordered_map<string, size_t> position;
+    for (size_t i = 0; i < txs.size(); ++i) position[txs[i].getId()] = i;
+
+    vector<size_t> order;
+    mutex orderMutex;
+    auto saved = executor.observer.onTxEvaluated;
+    executor.observer.onTxEvaluated = [&](const string &txId, const string &, const TxDelta &) {
+        lock_guard<mutex> lock(orderMutex);
+        order.push_back(position.at(txId));
+    };
+    State copy = state;
+    executor.execute(mode, dag, txs, copy, threads, metrics);
+    executor.observer.onTxEvaluated = saved;
+
+    if (order.size() != txs.size()) return false;
+    unordered_map<string, size_t> maxToucher, maxWriter;   // position + 1, 0 = none
+    for (size_t p : order) {
+        for (auto &k : txs[p].getWriteSet())
+            if (maxToucher[k] > p) return false;
+        for (auto &k : txs[p].getReadSet())
+            if (maxWriter[k] > p) return false;
+        for (auto &k : txs[p].getReadSet()) maxToucher[k] = max(maxToucher[k], p + 1);
+        for (auto &k : txs[p].getWriteSet()) {
+            maxToucher[k] = max(maxToucher[k], p + 1);
+            maxWriter[k] = max(maxWriter[k], p + 1);
+        }
+    }
+    return true;
+}
+
+// Runs every strategy on its own copy of the same initial state, checks that all
+// of them reach the sequential result and prints a timing table. `state` ends up
+// holding the sequential result.
+static void runComparison(Executor &executor, DAG &dag, vector<Transaction> &txs, State &state,
+                          size_t threads, Metrics &metrics) {
+    State reference = state;
+    executor.executeSequential(dag, txs, reference, threads, metrics);
+
+    // waves prints per-transaction progress, so the table is printed at the end
+    ostringstream table;
+    table << "\n" << left << setw(12) << "strategy" << right << setw(12) << "runUs"
+          << setw(12) << "speedup" << setw(12) << "allocs/tx" << "  state  order\n";
+    long long baseUs = 0;
+    for (ExecutionMode mode : allExecutionModes()) {
+        State copy = state;
+        uint64_t allocsBefore = allocationCount();
+        long long runUs = metrics.measureDurationUs([&]() {
+            executor.execute(mode, dag, txs, copy, threads, metrics);
+        });
+        double allocsPerTx = txs.empty() ? 0.0 : (double)(allocationCount() - allocsBefore) / txs.size();
+        if (mode == ExecutionMode::Sequential) baseUs = runUs;
+
+        bool same = copy.getBalances() == reference.getBalances();
+        bool ordered = checkApplyOrder(executor, mode, dag, txs, state, threads, metrics);
+        double speedup = runUs > 0 ? (double)baseUs / (double)runUs : 0.0;
+        table << left << setw(12) << executionModeName(mode) << right << setw(12) << runUs
+              << setw(12) << fixed << setprecision(2) << speedup
+              << setw(12) << setprecision(1);
+        if (allocationCountingEnabled()) table << allocsPerTx;
+        else table << "-";
+        table << "  " << (same ? "ok     " : "MISMATCH") << (ordered ? "ok" : "VIOLATED") << "\n";
+    }
+    if (allocationCountingEnabled())
+        table << "allocs/tx: whole run (per-block setup, and tracing in waves) over block size\n";
+    cout << table.str();
+    measurePoolAllocations(threads, max<size_t>(txs.size(), 1024), 8, metrics);
+    state = reference;
+}
+
+// Rehashes only the keys the block touched, then cross-checks the root against
+// a from-scratch build of the same state
+static void publishStateRoot(StateCommitment &commitment, State &state, size_t threads, Metrics &metrics) {
+    auto dirty = state.takeDirtyKeys();
+    ThreadPool pool(threads);
+    size_t hashed = 0;
+    long long updateUs = metrics.measureDurationUs([&]() {
+        hashed = commitment.update(state, dirty, &pool);
+    });
+
+    StateCommitment fresh(commitment.getDepth());
+    long long fullUs = metrics.measureDurationUs([&]() { fresh.build(state, &pool); });
+    bool verified = fresh.root() == commitment.root();
+
+    metrics.log("stateroot keys=" + to_string(state.getBalances().size()) +
+                " dirtyKeys=" + to_string(dirty.size()) +
+                " hashedNodes=" + to_string(hashed) +
+                " updateUs=" + to_string(updateUs) +
+                " fullUs=" + to_string(fullUs) +
+                " verified=" + (verified ? string("1") : string("0")) +
+                " root=" + commitment.rootHex());
+    cout << "\nState root " << commitment.rootHex() << "\n  " << dirty.size() << " dirty keys, "
+         << hashed << " nodes rehashed in " << updateUs << " us (full rebuild " << fullUs << " us), "
+         << (verified ? "matches full rebuild" : "MISMATCH with full rebuild") << "\n";
+}
+
+// Replays the block `rounds` times as a recurring payout: same accounts and
+// access pattern, new tx ids and fees each round. Every round goes through the
+// schedule cache and is checked against a sequential run.
+static void runScheduleCacheDemo(Executor &executor, vector<Transaction> &txs, State &state, size_t threads,
+                                 size_t rounds, const string &cacheDir, Metrics &metrics) {
+    ScheduleCache cache(cacheDir);
+    State initial = state;
+    for (size_t r = 0; r < rounds; ++r) {
+        vector<Transaction> block;
+        block.reserve(txs.size());
+        for (auto &tx : txs) {
+            block.emplace_back("R" + to_string(r) + "-" + tx.getId(),
+                               tx.getReadSet(), tx.getWriteSet(),
+                               tx.getFee() + (int)r, tx.getTimestamp() + (long long)(r * txs.size()));
+        }
+
+        State run = initial;
+        size_t hitsBefore = cache.hits;
+        long long us = metrics.measureDurationUs([&]() {
+            executor.executeWithScheduleCache(block, run, cache, threads, metrics);
+        });
+
+        State reference = initial;
+        DAG dag;
+        dag.buildFromTransactions(block);
+        Executor sequential;
+        sequential.executeSequential(dag, block, reference, 1, metrics);
+
+        cout << "Round " << r + 1 << ": " << (cache.hits > hitsBefore ? "hit " : "miss")
+             << " in " << us << " us, state "
+             << (run.getBalances() == reference.getBalances() ? "ok" : "MISMATCH") << "\n";
+        if (r + 1 == rounds) state = run;
+    }
+    cout << "Schedule cache: " << cache.hits << "/" << cache.lookups << " hits ("
+         << fixed << setprecision(0) << cache.hitRate() * 100 << "%), "
+         << cache.rejected << " rejected, " << cache.savedUs << " us saved\n";
+}
+
+// Runs the block once, amends it (replace, remove, append one transaction each),
+// re-executes incrementally and checks the result against a from-scratch run.
+static void runIncrementalDemo(vector<Transaction> &txs, State &state, size_t threads, Metrics &metrics) {
+    State initial = state;
+    IncrementalExecutor inc;
+    inc.executeBlock(txs, state, ExecutionMode::DependencyDriven, threads, metrics);
+    if (txs.size() < 3) return;
+
+    const Transaction &victim = txs[txs.size() / 2];
+    inc.replaceTransaction(Transaction(victim.getId(),
+        unordered_set<string>(victim.getWriteSet()), unordered_set<string>(victim.getReadSet()),
+        victim.getFee(), victim.getTimestamp()));
+    inc.removeTransaction(txs[txs.size() / 3].getId());
+    const Transaction &last = txs.back();
+    inc.addTransaction(Transaction("TxAmend",
+        unordered_set<string>(last.getWriteSet()), unordered_set<string>(txs.front().getReadSet()),
+        1, last.getTimestamp() + 1));
+    if (inc.addTransaction(txs.front()))
+        cerr << "Incremental: duplicate id " << txs.front().getId() << " was accepted\n";
+
+    size_t ran = 0;
+    long long incUs = metrics.measureDurationUs([&]() { ran = inc.reexecute(state, metrics); });
+
+    // reference: rebuild and re-run the amended block from scratch
+    State fresh = initial;
+    auto block = inc.currentBlock();
+    long long fullUs = metrics.measureDurationUs([&]() {
+        DAG fullDag;
+        fullDag.buildFromTransactions(block);
+        Executor reference;
+        reference.executeSequential(fullDag, block, fresh, 1, metrics);
+    });
+
+    bool same = fresh.getBalances() == state.getBalances();
+    cout << "\nIncremental re-execution: " << ran << " of " << block.size() << " txs in "
+         << incUs << " us (from scratch: " << fullUs << " us), state "
+         << (same ? "ok" : "MISMATCH") << "\n";
+}
+
+// Replays every strategy's schedule on virtual worker counts and, where the
+// machine has that many cores, checks the prediction against a real run.
+static void runSimulation(Executor &executor, DAG &dag, vector<Transaction> &txs, State &state,
+                          const vector<size_t> &workerCounts, const string &costSpec, unsigned seed,
+                          Metrics &metrics) {
+    CostModel cost;
+    if (costSpec.rfind("constant:", 0) == 0) {
+        cost = CostModel::constant(txs.size(), stod(costSpec.substr(9)));
+    } else if (costSpec.rfind("sampled:", 0) == 0) {
+        vector<double> samples;
+        ifstream in(costSpec.substr(8));
+        for (double ns; in >> ns;) samples.push_back(ns);
+        if (samples.empty()) cerr << "No cost samples in " << costSpec.substr(8) << ", all txs cost 0\n";
+        cost = CostModel::sampled(txs.size(), samples, seed);
+    } else {
+        if (costSpec != "calibrated") cerr << "Unknown cost model " << costSpec << ", calibrating\n";
+        // median of three sequential runs, so one cold run doesn't set the scale
+        vector<long long> seqUs;
+        for (int run = 0; run < 3; ++run) {
+            State copy = state;
+            seqUs.push_back(metrics.measureDurationUs([&]() {
+                executor.executeSequential(dag, txs, copy, 1, metrics);
+            }));
+        }
+        sort(seqUs.begin(), seqUs.end());
+        cost = CostModel::calibrate(txs, metrics, txs.empty() ? 0.0 : seqUs[1] * 1000.0 / txs.size());
+    }
+
+    // median of `reps` real runs; a single run of a few ms is at the mercy of the scheduler
+    const int reps = 5;
+    auto medianRunUs = [&](ExecutionMode mode, size_t w, State &out) {
+        vector<long long> us;
+        for (int run = 0; run < reps; ++run) {
+            out = state;
+            us.push_back(metrics.measureDurationUs([&]() { executor.execute(mode, dag, txs, out, w, metrics); }));
+        }
+        sort(us.begin(), us.end());
+        return us[reps / 2];
+    };
+
+    ScheduleSimulator sim(dag, txs, executor.partitionStrategy);
+    if (cost.kind == CostModelKind::Calibrated) {
+        sim.calibrateDispatch(cost, metrics);
+        // What a real run costs beyond its modelled work: metrics lines flushed
+        // per run, pool warm-up, caches cold from the previous strategy. Fitted
+        // per strategy on one worker, in runs kept apart from the check below,
+        // and charged as a constant at every worker count. The strategies take
+        // turns so none always follows the same one; the median run is used.
+        // A first untimed round pays the process's one-time costs (heap growth,
+        // first-touch page faults), which no later run sees. waves is not
+        // fitted for the same reason it is not checked.
+        vector<ExecutionMode> fitModes;
+        for (ExecutionMode mode : allExecutionModes())
+            if (ScheduleSimulator::supports(mode) && mode != ExecutionMode::Waves) fitModes.push_back(mode);
+        vector<vector<long long>> fitUs(fitModes.size());
+        for (int rep = -1; rep < reps; ++rep) {
+            for (size_t k = 0; k < fitModes.size(); ++k) {
+                size_t i = (k + (size_t)(rep + 1)) % fitModes.size();
+                State copy = state;
+                long long us = metrics.measureDurationUs([&]() {
+                    executor.execute(fitModes[i], dag, txs, copy, 1, metrics);
+                });
+                if (rep >= 0) fitUs[i].push_back(us);
+            }
+        }
+        vector<double> offsets(allExecutionModes().size(), 0.0);
+        string fitted;
+        for (size_t i = 0; i < fitModes.size(); ++i) {
+            sort(fitUs[i].begin(), fitUs[i].end());
+            size_t m = (size_t)fitModes[i];
+            offsets[m] = fitUs[i][reps / 2] * 1000.0 - sim.simulate(fitModes[i], 1, cost).makespanNs;
+            fitted += " " + executionModeName(fitModes[i]) + "=" + to_string((long long)(offsets[m] / 1000));
+        }
+        cost.runNs = offsets;
+        metrics.log("simcal runOffsetUs" + fitted);
+    }
+    ostringstream table;
+    table << "\nSimulated schedules (" << cost.name() << " cost, mean "
+          << fixed << setprecision(0) << cost.meanTxNs() << " ns/tx)\n"
+          << left << setw(12) << "strategy" << right << setw(9) << "workers" << setw(14) << "makespanUs"
+          << setw(9) << "util" << setw(16) << "barrierIdleUs" << setw(10) << "barriers" << setw(10) << "setupUs" << "\n";
+    for (ExecutionMode mode : allExecutionModes()) {
+        if (!ScheduleSimulator::supports(mode)) continue;
+        for (size_t w : workerCounts) {
+            SimResult r = sim.simulate(mode, w, cost);
+            table << left << setw(12) << executionModeName(mode) << right << setw(9) << r.workers
+                  << setw(14) << setprecision(0) << r.makespanNs / 1000
+                  << setw(8) << setprecision(1) << r.utilization() * 100 << "%"
+                  << setw(16) << setprecision(0) << r.barrierIdleNs / 1000
+                  << setw(10) << r.barriers << setw(10) << r.setupNs / 1000 << "\n";
+            metrics.log("sim strategy=" + executionModeName(mode) + " workers=" + to_string(r.workers) +
+                        " cost=" + cost.name() +
+                        " makespanUs=" + to_string((long long)(r.makespanNs / 1000)) +
+                        " utilization=" + to_string(r.utilization()) +
+                        " barrierIdleUs=" + to_string((long long)(r.barrierIdleNs / 1000)) +
+                        " barriers=" + to_string(r.barriers) + " tasks=" + to_string(r.tasks) +
+                        " setupUs=" + to_string((long long)(r.setupNs / 1000)));
+            if (mode == ExecutionMode::Sequential) break;
+        }
+    }
+    cout << table.str();
+
+    // validation: real runs only where each virtual worker can have its own core;
+    // waves is skipped because its per-transaction console output dominates
+    size_t cores = max<size_t>(1, thread::hardware_concurrency());
+    State reference = state;
+    ostringstream check;
+    double maxAbsErrorPct = 0.0;
+    size_t runs = 0, over = 0;
+    check << fixed << "\nSimulator check (" << cores << " cores)\n" << left << setw(12) << "strategy" << right
+          << setw(9) << "workers" << setw(14) << "predictedUs" << setw(14) << "measuredUs" << setw(10) << "error" << "\n";
+    for (ExecutionMode mode : allExecutionModes()) {
+        if (!ScheduleSimulator::supports(mode) || mode == ExecutionMode::Waves) continue;
+        for (size_t w : workerCounts) {
+            if (w > cores) continue;
+            SimResult r = sim.simulate(mode, w, cost);
+            State copy;
+            long long us = medianRunUs(mode, w, copy);
+            if (mode == ExecutionMode::Sequential) reference = copy;
+            double predictedUs = r.makespanNs / 1000;
+            double errorPct = us > 0 ? (predictedUs - (double)us) * 100.0 / (double)us : 0.0;
+            check << left << setw(12) << executionModeName(mode) << right << setw(9) << r.workers
+                  << setw(14) << setprecision(0) << predictedUs << setw(14) << us
+                  << setw(9) << setprecision(1) << errorPct << "%"
+                  << (fabs(errorPct) > kSimErrorBoundPct ? "  !" : "") << "\n";
+            maxAbsErrorPct = max(maxAbsErrorPct, fabs(errorPct));
+            runs++;
+            if (fabs(errorPct) > kSimErrorBoundPct) over++;
+            metrics.log("simcheck strategy=" + executionModeName(mode) + " workers=" + to_string(r.workers) +
+                        " predictedUs=" + to_string((long long)predictedUs) +
+                        " measuredUs=" + to_string(us) + " errorPct=" + to_string(errorPct));
+            if (mode == ExecutionMode::Sequential) break;
+        }
+    }
+    if (runs > 0) {
+        check << "max |error| " << setprecision(1) << maxAbsErrorPct << "% over " << runs
+              << " runs (bound " << setprecision(0) << kSimErrorBoundPct << "%)\n";
+        metrics.log("simaccuracy maxAbsErrorPct=" + to_string(maxAbsErrorPct) + " runs=" + to_string(runs) +
+                    " over=" + to_string(over) + " boundPct=" + to_string(kSimErrorBoundPct));
+    }
+    cout << check.str();
+    if (over > 0)
+        cerr << "Warning: " << over << " of " << runs << " simulator predictions are off by more than "
+             << kSimErrorBoundPct << "% (marked !); treat the simulated makespans as rough\n";
+    state = reference;
+}
+
+// Waves batches cut from the DAG never conflict internally, so both
+// partitioners return one group there. They differ on candidate sets that do
+// conflict, e.g. what a mempool scheduler receives. Here those sets are
+// consecutive `window`-sized slices of the block, each partitioned as-is. Each
+// strategy gets its groups run on the pool with one barrier per group, and the
+// run reports group count, rounds at `threads` and makespan.
+static void runPartitionDemo(const vector<Transaction> &txs, size_t threads, size_t window, Metrics &metrics) {
+    unordered_map<string, const Transaction*> lookup;
+    for (auto &tx : txs) lookup[tx.getId()] = &tx;
+    window = max<size_t>(1, min(window, txs.size()));
+
+    const vector<PartitionStrategy> strategies = {PartitionStrategy::Greedy, PartitionStrategy::DSatur};
+    vector<vector<vector<vector<string>>>> windows(strategies.size());
+    vector<long long> partitionUs(strategies.size());
+    for (size_t s = 0; s < strategies.size(); ++s) {
+        partitionUs[s] = metrics.measureDurationUs([&]() {
+            for (size_t begin = 0; begin < txs.size(); begin += window) {
+                vector<string> ids;
+                for (size_t i = begin; i < min(txs.size(), begin + window); ++i) ids.push_back(txs[i].getId());
+                windows[s].push_back(partitionIntoConflictFreeGroups(ids, lookup, strategies[s]));
+            }
+        });
+    }
+
+    // Group execution is short and noisy, and whichever strategy runs first
+    // pays for cold caches. Both share one pool and alternate which goes first
+    // each repetition; the median is reported.
+    const size_t reps = 9;
+    vector<vector<long long>> makespans(strategies.size());
+    State scratch;   // groups are conflict-free, not in block order
+    mutex stateMutex;
+    ThreadPool pool(threads);
+    for (size_t rep = 0; rep < reps; ++rep) {
+        for (size_t k = 0; k < strategies.size(); ++k) {
+            size_t s = rep % 2 ? strategies.size() - 1 - k : k;
+            makespans[s].push_back(metrics.measureDurationUs([&]() {
+                for (auto &w : windows[s]) {
+                    for (auto &group : w) {
+                        for (auto &id : group) {
+                            const Transaction *tx = lookup.at(id);
+                            pool.enqueue([tx, &scratch, &stateMutex]() {
+                                TxDelta delta = evaluateTransaction(*tx);
+                                lock_guard<mutex> lock(stateMutex);
+                                scratch.applyDelta(delta);
+                            });
+                        }
+                        pool.waitAll();
+                    }
+                }
+            }));
+        }
+    }
+
+    cout << "\nPartitioning " << txs.size() << " txs in windows of " << window << " (" << threads << " threads, makespan median of "
+         << reps << ")\n"
+         << left << setw(10) << "strategy" << right << setw(9) << "groups" << setw(10) << "minGroup"
+         << setw(10) << "maxGroup" << setw(9) << "rounds" << setw(14) << "partitionUs" << setw(13) << "makespanUs" << "\n";
+    for (size_t s = 0; s < strategies.size(); ++s) {
+        size_t groups = 0, rounds = 0, minGroup = txs.size(), maxGroup = 0;
+        for (auto &w : windows[s]) {
+            groups += w.size();
+            rounds += partitionRounds(w, threads);
+            for (auto &g : w) {
+                minGroup = min(minGroup, g.size());
+                maxGroup = max(maxGroup, g.size());
+            }
+        }
+        sort(makespans[s].begin(), makespans[s].end());
+        long long makespanUs = makespans[s][reps / 2];
+
+        cout << left << setw(10) << partitionStrategyName(strategies[s]) << right << setw(9) << groups
+             << setw(10) << minGroup << setw(10) << maxGroup << setw(9) << rounds
+             << setw(14) << partitionUs[s] << setw(13) << makespanUs << "\n";
+        metrics.log("partition strategy=" + partitionStrategyName(strategies[s]) +
+                    " window=" + to_string(window) + " threads=" + to_string(threads) +
+                    " windows=" + to_string(windows[s].size()) + " groups=" + to_string(groups) +
+                    " minGroup=" + to_string(minGroup) + " maxGroup=" + to_string(maxGroup) +
+                    " rounds=" + to_string(rounds) + " partitionUs=" + to_string(partitionUs[s]) +
+                    " makespanUs=" + to_string(makespanUs) + " reps=" + to_string(reps));
+    }
+}
+
+// Command-line options. With no arguments the 10-transaction demo runs exactly as before.
+struct RunOptions {
+    string mode = "waves";      // any executionModeName(), or prefetch | multiprocess | incremental | cached | simulate | spill | partition | adaptive | compare
+    size_t threads = 4;
+    size_t syntheticTxs = 0;    // 0 = demo block from createSampleTransactions()
+    size_t syntheticKeys = 1000;
+    double hotKeyRatio = 0.0;
+    unsigned seed = 42;
+    long long coldLatencyUs = 200;  // prefetch mode: simulated cold-key load latency
+    size_t inFlight = 16;           // prefetch mode: suspended txs per worker (1 = blocking)
+    size_t crashAfter = 0;          // multiprocess mode: workers die after N tasks (test hook)
+    size_t killEveryUs = 0;         // multiprocess mode: SIGKILL a random worker this often (test hook)
+    string partition = "greedy";    // waves mode: greedy | dsatur
+    string liveStats;               // shm segment name for tools/live_stats (empty = off)
+    size_t traceChunk = 0;          // events per trace/chunk_*.json (0 = one trace.json at exit)
+    bool perf = false;              // per-phase / per-worker hardware counters
+    size_t repeat = 5;              // cached mode: rounds of the same block shape
+    string cacheDir;                // cached mode: also keep schedules on disk here
+    bool stateRoot = false;         // maintain a Merkle commitment and publish its root
+    vector<size_t> workers = {1, 2, 4, 8, 16, 32, 64, 128};  // simulate mode: virtual worker counts
+    string cost = "calibrated";     // simulate mode: calibrated | constant:NS | sampled:FILE
+    size_t window = 512;            // partition mode: candidate set size
+    string spillDir = "spill";      // spill mode: level-ordered transaction files
+    size_t memoryBudgetMb = 64;     // spill mode: everything the out-of-core executor holds for the block
+    size_t lookahead = 2;           // spill mode: segments paged in ahead of the executing one
+};
+
+static RunOptions parseOptions(int argc, char** argv) {
+    RunOptions opt;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--mode" && hasValue) opt.mode = argv[++i];
+        else if (arg == "--threads" && hasValue) opt.threads = stoul(argv[++i]);
+        else if (arg == "--txs" && hasValue) opt.syntheticTxs = stoul(argv[++i]);
+        else if (arg == "--keys" && hasValue) opt.syntheticKeys = stoul(argv[++i]);
+        else if (arg == "--hot" && hasValue) opt.hotKeyRatio = stod(argv[++i]);
+        else if (arg == "--seed" && hasValue) opt.seed = (unsigned)stoul(argv[++i]);
+        else if (arg == "--latency-us" && hasValue) opt.coldLatencyUs = stoll(argv[++i]);
+        else if (arg == "--inflight" && hasValue) opt.inFlight = stoul(argv[++i]);
+        else if (arg == "--crash-after" && hasValue) opt.crashAfter = stoul(argv[++i]);
+        else if (arg == "--kill-every-us" && hasValue) opt.killEveryUs = stoul(argv[++i]);
+        else if (arg == "--partition" && hasValue) opt.partition = argv[++i];
+        else if (arg == "--live-stats" && hasValue) opt.liveStats = argv[++i];
+        else if (arg == "--trace-chunk" && hasValue) opt.traceChunk = stoul(argv[++i]);
+        else if (arg == "--perf") opt.perf = true;
+        else if (arg == "--repeat" && hasValue) opt.repeat = stoul(argv[++i]);
+        else if (arg == "--cache-dir" && hasValue) opt.cacheDir = argv[++i];
+        else if (arg == "--state-root") opt.stateRoot = true;
+        else if (arg == "--workers" && hasValue) {
+            opt.workers.clear();
+            stringstream list(argv[++i]);
+            for (string w; getline(list, w, ',');) if (!w.empty()) opt.workers.push_back(max<size_t>(1, stoul(w)));
+        }
+        else if (arg == "--cost" && hasValue) opt.cost = argv[++i];
+        else if (arg == "--window" && hasValue) opt.window = stoul(argv[++i]);
+        else if (arg == "--spill-dir" && hasValue) opt.spillDir = argv[++i];
+        else if (arg == "--memory-budget-mb" && hasValue) opt.memoryBudgetMb = max<size_t>(1, stoul(argv[++i]));
+        else if (arg == "--lookahead" && hasValue) opt.lookahead = stoul(argv[++i]);
+        else cerr << "Ignoring unknown argument: " << arg << "\n";
+    }
+    if (opt.threads == 0) opt.threads = 1;
+    return opt;
+}
+
+// Streams the block into an OutOfCoreExecutor without materialising it and runs
+// it within the memory budget. Blocks small enough for the in-memory path are
+// then run again as ThreadPoolBatches (same level barriers) to price the spill
+// and check the final state.
+static void runOutOfCoreDemo(const RunOptions &opt, Metrics &metrics) {
+    SpillConfig config;
+    config.dir = opt.spillDir;
+    config.memoryBudgetBytes = opt.memoryBudgetMb << 20;
+    config.lookaheadSegments = opt.lookahead;
+    OutOfCoreExecutor outOfCore(config);
+
+    bool ok = true;
+    if (opt.syntheticTxs > 0) {
+        forEachSyntheticTransaction(opt.syntheticTxs, opt.syntheticKeys, opt.hotKeyRatio, opt.seed,
+                                    [&](const Transaction &tx) { ok = ok && outOfCore.add(tx); });
+    } else {
+        for (auto &tx : createSampleTransactions()) ok = ok && outOfCore.add(tx);
+    }
+    auto initialState = [&]() {
+        return opt.syntheticTxs > 0 ? createSyntheticState(opt.syntheticKeys, 1000) : createInitialState();
+    };
+    State state = initialState();
+    if (!ok || !outOfCore.execute(state, opt.threads, metrics)) {
+        cerr << "Out-of-core execution failed (spill directory " << config.dir << ")\n";
+        return;
+    }
+
+    const SpillStats &st = outOfCore.getStats();
+    long long totalUs = st.spillUs + st.sealUs + st.executeUs;
+    cout << "\nOut-of-core: " << st.txs << " txs, " << st.levels << " levels, "
+         << st.bytes / 1024 << " KB spilled in " << st.segments << " segments of "
+         << st.segmentBytes / 1024 << " KB, " << st.bucketFlushes << " bucket flush(es)\n"
+         << "  spill " << st.spillUs << " us, sort " << st.sealUs << " us, execute " << st.executeUs << " us ("
+         << (st.executeUs > 0 ? (long long)(st.txs * 1000000.0 / st.executeUs) : 0) << " tx/s)\n"
+         << "  budgeted peak " << st.peakBudgetedBytes / 1024 << " KB of " << opt.memoryBudgetMb
+         << " MB (" << st.keySlots << " key slots, peak mapped " << st.peakMappedBytes / 1024
+         << " KB), process peak RSS " << st.peakRssBytes / 1024 << " KB\n"
+         << "  " << st.prefetchStalls << " prefetch stalls, "
+         << st.segmentDrains << " mid-level segment drains\n";
+
+    // the in-memory DAG build is quadratic, so only small blocks get a baseline
+    const size_t baselineMaxTxs = 20000;
+    if (st.txs > baselineMaxTxs) {
+        cout << "  (in-memory baseline skipped above " << baselineMaxTxs << " txs)\n";
+    } else {
+        auto txs = opt.syntheticTxs > 0
+            ? createSyntheticTransactions(opt.syntheticTxs, opt.syntheticKeys, opt.hotKeyRatio, opt.seed)
+            : createSampleTransactions();
+        State reference = initialState();
+        DAG dag;
+        Executor executor;
+        long long buildUs = metrics.measureDurationUs([&]() { dag.buildFromTransactions(txs); });
+        long long runUs = metrics.measureDurationUs([&]() {
+            executor.execute(ExecutionMode::ThreadPoolBatches, dag, txs, reference, opt.threads, metrics);
+        });
+        bool same = reference.getBalances() == state.getBalances();
+        double execRatio = runUs > 0 ? (double)st.executeUs / (double)runUs : 0.0;
+        cout << "  in-memory pool: DAG build " << buildUs << " us, execute " << runUs << " us; out-of-core execute is "
+             << fixed << setprecision(2) << execRatio << "x, end to end " << totalUs << " vs "
+             << buildUs + runUs << " us; state " << (same ? "ok" : "MISMATCH") << "\n";
+        metrics.log("outofcore baseline strategy=pool buildUs=" + to_string(buildUs) +
+                    " runUs=" + to_string(runUs) + " outOfCoreUs=" + to_string(totalUs) +
+                    " executeRatio=" + to_string(execRatio) + " state=" + (same ? "ok" : "mismatch"));
+    }
+    state.display();
+}
+
 int main(int argc, char** argv) {
     cout << "=== Parallel DAG Executor — with GUI-friendly export ===\n";
+    RunOptions opt = parseOptions(argc, argv);
+    Metrics metrics;
+    if (opt.perf) PerfProfiler::get().enable();
 
-    // create sample transactions & build DAG
-    auto txs = createSampleTransactions();
+    // spill streams the block itself: it must not be materialised or built into a DAG here
+    if (opt.mode == "spill") {
+        runOutOfCoreDemo(opt, metrics);
+        PerfProfiler::get().writeSummary(metrics);
+        return 0;
+    }
+
+    // create sample (or synthetic benchmark) transactions & build DAG
+    auto txs = opt.syntheticTxs > 0
+        ? createSyntheticTransactions(opt.syntheticTxs, opt.syntheticKeys, opt.hotKeyRatio, opt.seed)
+        : createSampleTransactions();
     DAG dag;
-    dag.buildFromTransactions(txs);
+    metrics.measurePhase("dag_build", [&]() { dag.buildFromTransactions(txs); });
 
     // Export DOT as before (optional)
     DAGExporter::exportToDOT(dag, "dag_output.dot");
@@ -109,25 +711,93 @@ int main(int argc, char** argv) {
     DAGExporter::exportToJSON(dag, "dag_output_raw.json");
 
     // Prepare state + executor + metrics
-    State state = createInitialState();
+    State state = opt.syntheticTxs > 0
+        ? createSyntheticState(opt.syntheticKeys, 1000)
+        : createInitialState();
     Executor executor;
-    Metrics metrics;
+    if (!parsePartitionStrategy(opt.partition, executor.partitionStrategy))
+        cerr << "Unknown partition strategy " << opt.partition << ", using greedy\n";
     metrics.startGlobalTimer();
 
+    if (opt.traceChunk > 0 && !TraceWriter::get().openChunked("trace", opt.traceChunk)) {
+        cerr << "Could not create trace/, writing trace.json at exit\n";
+        opt.traceChunk = 0;
+    }
+
+    if (!opt.liveStats.empty()) {
+        if (LiveStats::get().open(opt.liveStats))
+            cout << "Publishing live stats to shared memory " << opt.liveStats << "\n";
+        else if (errno == EEXIST)
+            cerr << "Live stats segment " << opt.liveStats << " already exists (another run, or stale: remove /dev/shm"
+                 << opt.liveStats << ")\n";
+        else
+            cerr << "Could not create live stats segment " << opt.liveStats << ": " << strerror(errno) << "\n";
+    }
+
+    // Commitment of the pre-block state; the block then only marks keys dirty
+    StateCommitment commitment;
+    if (opt.stateRoot) {
+        ThreadPool pool(opt.threads);
+        long long fullUs = metrics.measureDurationUs([&]() { commitment.build(state, &pool); });
+        metrics.log("stateroot initial keys=" + to_string(state.getBalances().size()) +
+                    " fullUs=" + to_string(fullUs) + " root=" + commitment.rootHex());
+        state.setDirtyTracking(true);
+    }
+
     // Small example observer (kept minimal)
     executor.observer.onBatchStart = [](int batchId, const vector<string> &batch) {
         // keep observer light-weight
     };
 
     // Run execution and produce trace.json (TraceWriter is used inside Executor instrumentation)
-    executor.executeWithState(dag, txs, state, 4, metrics);
+    ExecutionMode mode = ExecutionMode::Waves;
+    if (opt.mode == "compare") runComparison(executor, dag, txs, state, opt.threads, metrics);
+    else if (opt.mode == "adaptive") executor.executeAdaptive(dag, txs, state, opt.threads, metrics);
+    else if (opt.mode == "prefetch") {
+        SlowStateBackend backend(chrono::microseconds(opt.coldLatencyUs), 32);
+        executor.executeWithPrefetch(dag, txs, state, backend, opt.threads, opt.inFlight, metrics);
+    }
+    else if (opt.mode == "incremental") runIncrementalDemo(txs, state, opt.threads, metrics);
+    else if (opt.mode == "cached")
+        runScheduleCacheDemo(executor, txs, state, opt.threads, opt.repeat, opt.cacheDir, metrics);
+    else if (opt.mode == "partition") runPartitionDemo(txs, opt.threads, opt.window, metrics);
+    else if (opt.mode == "simulate")
+        runSimulation(executor, dag, txs, state, opt.workers, opt.cost, opt.seed, metrics);
+    else if (opt.mode == "multiprocess") {
+        const State initialState = state;
+        MultiProcessExecutor mp(opt.threads);
+        mp.crashAfterTasks = opt.crashAfter;
+        mp.killEveryUs = opt.killEveryUs;
+        if (!mp.execute(dag, txs, state, metrics)) {
+            cerr << "Multi-process execution unavailable, running dependency mode\n";
+            executor.execute(ExecutionMode::DependencyDriven, dag, txs, state, opt.threads, metrics);
+        } else {
+            State reference = initialState;
+            executor.execute(ExecutionMode::DependencyDriven, dag, txs, reference, opt.threads, metrics);
+            cout << "\nMulti-process state vs dependency mode: "
+                 << (state.getBalances() == reference.getBalances() ? "ok" : "MISMATCH") << "\n";
+        }
+        mp.measureHandoffLatency(2000, metrics);
+        MultiProcessExecutor::measureScaling(dag, txs, initialState, opt.threads, metrics);
+    }
+    else if (parseExecutionMode(opt.mode, mode)) executor.execute(mode, dag, txs, state, opt.threads, metrics);
+    else {
+        cerr << "Unknown mode " << opt.mode << ", running waves\n";
+        executor.execute(ExecutionMode::Waves, dag, txs, state, opt.threads, metrics);
+    }
 
     cout << "\nTotal execution time: " << metrics.getElapsedMs() << " ms\n";
     state.display();
+    PerfProfiler::get().writeSummary(metrics);
+
+    if (opt.stateRoot) publishStateRoot(commitment, state, opt.threads, metrics);
 
     // Ensure trace is written out for GUI playback
     TraceWriter::get().flushToFile("trace.json");
-    cout << "Wrote trace.json and dag_output.json (augmented with read/write sets).\n";
+    cout << "Wrote " << (opt.traceChunk > 0 ? "trace/index.json + chunks" : "trace.json")
+         << " and dag_output.json (augmented with read/write sets).\n";
+
+    LiveStats::get().close();
 
     return 0;
 }
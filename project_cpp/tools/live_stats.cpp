@@ -0,0 +1,117 @@
+// live_stats.cpp
+// Companion reader for the stats segment published with `app --live-stats <name>`.
+//   live_stats [--name /dipetrans-stats] [--watch ms] [--json]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include "LiveStats.h"
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace livestats;
+
+struct Totals {
+    uint64_t completed = 0;
+    uint64_t latency[kLatencyBuckets] = {};
+    size_t busySlots = 0;
+};
+
+static Totals sumWorkers(const Segment *seg) {
+    Totals t;
+    for (size_t w = 0; w < kWorkerSlots; ++w) {
+        uint64_t n = seg->workers[w].txCompleted.load(memory_order_relaxed);
+        if (n) t.busySlots++;
+        t.completed += n;
+        for (size_t b = 0; b < kLatencyBuckets; ++b)
+            t.latency[b] += seg->workers[w].latency[b].load(memory_order_relaxed);
+    }
+    return t;
+}
+
+// upper bound (ns) of the bucket holding quantile q
+static uint64_t quantileNs(const Totals &t, double q) {
+    uint64_t n = 0;
+    for (uint64_t c : t.latency) n += c;
+    if (n == 0) return 0;
+    uint64_t target = (uint64_t)(q * n), seen = 0;
+    for (size_t b = 0; b < kLatencyBuckets; ++b) {
+        seen += t.latency[b];
+        if (seen > target) return 2ull << b;
+    }
+    return 2ull << (kLatencyBuckets - 1);
+}
+
+static void printText(const Segment *seg, const Snapshot &s, const Totals &t) {
+    cout << "pid=" << seg->pid << " mode=" << s.mode
+         << " done=" << s.txCompleted << "/" << s.txTotal
+         << " tx/s=" << s.txPerSec
+         << " batch=" << s.currentBatch << " group=" << s.currentGroup
+         << " ready=" << s.readyQueueDepth << " active=" << s.activeWorkers
+         << " threads=" << t.busySlots
+         << " p50<" << quantileNs(t, 0.5) << "ns p99<" << quantileNs(t, 0.99) << "ns\n";
+}
+
+static void printJson(const Segment *seg, const Snapshot &s, const Totals &t) {
+    cout << "{\"pid\":" << seg->pid << ",\"mode\":\"" << s.mode << "\""
+         << ",\"txCompleted\":" << s.txCompleted << ",\"txTotal\":" << s.txTotal
+         << ",\"txPerSec\":" << s.txPerSec
+         << ",\"batch\":" << s.currentBatch << ",\"group\":" << s.currentGroup
+         << ",\"readyQueueDepth\":" << s.readyQueueDepth << ",\"activeWorkers\":" << s.activeWorkers
+         << ",\"latencyLog2Ns\":[";
+    for (size_t b = 0; b < kLatencyBuckets; ++b) cout << (b ? "," : "") << t.latency[b];
+    cout << "]}\n";
+}
+
+int main(int argc, char** argv) {
+    string name = "/dipetrans-stats";
+    long long watchMs = 0;
+    bool json = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--name" && i + 1 < argc) name = argv[++i];
+        else if (arg == "--watch" && i + 1 < argc) watchMs = stoll(argv[++i]);
+        else if (arg == "--json") json = true;
+        else cerr << "Ignoring unknown argument: " << arg << "\n";
+    }
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        cerr << "No stats segment " << name << " (is app running with --live-stats?)\n";
+        return 1;
+    }
+    void *p = mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        cerr << "mmap failed for " << name << "\n";
+        return 1;
+    }
+    const Segment *seg = static_cast<const Segment*>(p);
+    if (seg->magic != kMagic || seg->version != kVersion ||
+        seg->workerSlots != kWorkerSlots || seg->latencyBuckets != kLatencyBuckets) {
+        cerr << "Segment " << name << " has an unexpected layout\n";
+        munmap(p, sizeof(Segment));
+        return 1;
+    }
+
+    do {
+        Snapshot snap;
+        if (!readSnapshot(seg, snap)) {
+            cerr << "Writer kept the snapshot busy, retrying\n";
+        } else {
+            Totals t = sumWorkers(seg);
+            if (json) printJson(seg, snap, t);
+            else printText(seg, snap, t);
+        }
+        cout.flush();   // one line per snapshot even when piped
+        if (watchMs > 0) this_thread::sleep_for(chrono::milliseconds(watchMs));
+    } while (watchMs > 0);
+
+    munmap(p, sizeof(Segment));
+    return 0;
+}